@@ -1,11 +1,14 @@
 #include "Agent.h"
 #include "Model.h"
+#include "State_hash.h"
+#include "Binary_writer.h"
+#include "Binary_reader.h"
 #include "Utility.h"
-#include <iostream>//cout, endl
+#include "Flow_field.h"
+#include <ostream>//endl
 #include <iomanip>//changing output settings(precision)
 #include <cassert>//assert
 
-using std::cout;
 using std::endl;
 using std::string;
 using std::ios;
@@ -39,17 +42,20 @@ bool Agent::is_moving() const
 void Agent::move_to(Point destination_)
 {
     if(destination_ == moving_obj.get_current_location()) {
-        cout << get_name() << ": I'm already there" << endl;
+        get_output() << get_name() << ": I'm already there" << endl;
         return;
     }
-    cout << get_name() <<  ": I'm on the way" << endl;
-    moving_obj.start_moving(destination_);
+    get_output() << get_name() <<  ": I'm on the way" << endl;
+    will_change();
+    moving_obj.start_moving(destination_,
+                            get_model().get_flow_field(destination_));
 }
 //Stops moving and announces they've stopped moving
 void Agent::stop()
 {
     if(moving_obj.is_currently_moving())  {
-        cout << get_name() << ": I'm stopped" << endl;
+        get_output() << get_name() << ": I'm stopped" << endl;
+        will_change();
         moving_obj.stop_moving();
     }
 }
@@ -63,17 +69,18 @@ void Agent::take_hit(int attack_strength,
 //Otherwise shouts "Ouch!" and continues its business
 void Agent::lose_health(int attack_strength)
 {
+    will_change();
     health -= attack_strength;
     if(health <= 0) {
         alive = false;
         moving_obj.stop_moving();
-        Model::get_instance().notify_gone(get_name());
-        cout << get_name() << ": Arrggh!" << endl;
-        Model::get_instance().remove_agent(shared_from_this());
+        get_model().notify_gone(get_name());
+        get_output() << get_name() << ": Arrggh!" << endl;
+        get_model().remove_agent(shared_from_this());
         return;
     }
     broadcast_current_state();//if alive, notify model we took damage
-    cout << get_name() << ": Ouch!" << endl;
+    get_output() << get_name() << ": Ouch!" << endl;
 }
 //Has the agent update its movement if alive
 void Agent::update()
@@ -82,47 +89,102 @@ void Agent::update()
         update_Movement();
     }
 }
-//Calls moving_obj's update location; if there, announces such.
+//Picks up a fresh flow field if the world has changed, then
+//calls moving_obj's update location; if there, announces such.
 //If not, announces it's taken another step.
 //Either way, notifies model.
 void Agent::update_Movement()
 {
+    if(moving_obj.is_currently_moving()) {
+        will_change();
+    }
+    shared_ptr<const Flow_field> field = moving_obj.get_current_field();
+    if(field && field->is_stale()) {
+        moving_obj.set_field(
+            get_model().get_flow_field(field->get_destination()));
+    }
     if(moving_obj.update_location()) {
-        cout << get_name() << ": I'm there!" << endl;
+        get_output() << get_name() << ": I'm there!" << endl;
     }
     else if(moving_obj.is_currently_moving()) {
-        cout << get_name() << ": step..." << endl;
+        get_output() << get_name() << ": step..." << endl;
     }
-    Model::get_instance().notify_location(get_name(),
+    get_model().notify_location(get_name(),
                                  moving_obj.get_current_location());
 }
 //Outputs all information on the current state of the agent.
 void Agent::describe() const
 {
-    cout << get_name() << " at " <<
+    std::ostream& os = get_output();
+    os << get_name() << " at " <<
         moving_obj.get_current_location() << endl;
     if(is_alive()) {
-        cout << "   Health is " << health << endl;
+        os << "   Health is " << health << endl;
         if(is_moving()) {
-            auto old_settings = cout.precision();
-            cout << std::fixed << std::setprecision(default_precision_c);
-            cout << "   Moving at speed " << speed << " to " <<
+            auto old_settings = os.precision();
+            os << std::fixed << std::setprecision(default_precision_c);
+            os << "   Moving at speed " << speed << " to " <<
                 moving_obj.get_current_destination() << endl;
-            cout.precision(old_settings);//save and restore old settings
+            os.precision(old_settings);//save and restore old settings
         }
         else  {
-            cout << "   Stopped" << endl;
+            os << "   Stopped" << endl;
         }
         return;//no need to check dying state if is alive
     }
     else
-        cout << "   Is dead" << endl;
+        os << "   Is dead" << endl;
+}
+//The destination only counts while moving
+void Agent::hash_state(State_hash& hash) const
+{
+    Sim_object::hash_state(hash);
+    hash.add(health);
+    hash.add(alive);
+    Point location = moving_obj.get_current_location();
+    hash.add(location.x);
+    hash.add(location.y);
+    hash.add(moving_obj.is_currently_moving());
+    if(moving_obj.is_currently_moving()) {
+        Point destination = moving_obj.get_current_destination();
+        hash.add(destination.x);
+        hash.add(destination.y);
+    }
+}
+//A field belongs to a world, so only whether there was one is written;
+//the same way is asked for again when read back
+void Agent::write_state(Binary_writer& writer) const
+{
+    writer.put(static_cast<int32_t>(health));
+    moving_obj.write_state(writer);
+    bool has_field = moving_obj.get_current_field() != nullptr;
+    writer.put(static_cast<uint8_t>(has_field));
+}
+//Only living agents are written, so alive is left as it is
+void Agent::read_state(Binary_reader& reader)
+{
+    health = reader.get<int32_t>();
+    moving_obj.read_state(reader);
+    if(reader.get<uint8_t>()) {
+        moving_obj.set_field(get_model().get_flow_field(
+            moving_obj.get_current_destination()));
+    }
+}
+//A field belongs to the world that made it, so the same way is asked for
+//again
+void Agent::relink()
+{
+    shared_ptr<const Flow_field> field = moving_obj.get_current_field();
+    if(field) {
+        moving_obj.set_field(
+            get_model().get_flow_field(field->get_destination()));
+    }
 }
 //Tells Model about the current location of the Agent.
 void Agent::broadcast_current_state()
 {
-    Model::get_instance().notify_location(get_name(), get_location());
-    Model::get_instance().notify_health(get_name(), health);
+    get_model().notify_location(get_name(), get_location());
+    get_model().notify_health(get_name(), health);
 }
 //Throws error that it can't work
 void Agent::start_working(shared_ptr<Structure>,
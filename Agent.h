@@ -30,6 +30,11 @@ public:
     // return true if this Agent is in motion
     bool is_moving() const;
     
+    // return the distance this Agent covers per update when moving
+    double get_speed() const {
+        return speed;
+    }
+    
     // tell this Agent to start moving to location destination_
     virtual void move_to(Point destination_);
     
@@ -48,10 +53,23 @@ public:
     
     // output information about the current state
     void describe() const override;
+    // mixes in the health, where it is and where it is headed
+    void hash_state(State_hash& hash) const override;
+    
+    // writes or reads back the health and the movement, for a snapshot
+    void write_state(Binary_writer& writer) const override;
+    void read_state(Binary_reader& reader) override;
     
     // ask Model to broadcast our current state to all Views
     void broadcast_current_state() override;
     
+    // returns a copy of this Agent, to be added to another world; until it
+    // is relinked there, it still refers to things in this one
+    virtual std::shared_ptr<Agent> clone() const = 0;
+    
+    // follows a field from the world it is bound to now, if moving along one
+    void relink() override;
+    
     /* Fat Interface for derived classes */
     // Throws exception that an Agent cannot work.
     virtual void start_working(std::shared_ptr<Structure>,
@@ -60,6 +78,10 @@ public:
     // Throws exception that an Agent cannot attack.
     virtual void start_attacking(std::weak_ptr<Agent>);
     
+    // Called when a target this Agent hit has died of its wounds;
+    // does nothing by default.
+    virtual void target_killed(std::shared_ptr<Agent>) {}
+    
 protected:
     //protected to ensure no attempted instantiation of abstract class
     Agent(const std::string& name_, Point location_);
@@ -2,14 +2,15 @@
 #include "Geometry.h"
 #include "Warriors.h"
 #include "Peasant.h"
+#include "Type_registry.h"
 #include "Utility.h"
 
 using std::string;
+using std::vector;
 using std::shared_ptr;
 
-const char* const soldier_name_c = "Soldier";
-const char* const peasant_name_c = "Peasant";
-const char* const archer_name_c = "Archer";
+//every kind of Agent the factory can make
+typedef Type_registry<Agent, Soldier, Peasant, Archer> Agent_registry;
 
 
 //Creates and returns a shared_ptr to the specified Agent type
@@ -19,16 +20,24 @@ shared_ptr<Agent> create_agent(
                                const string& name,const string& type,
                                Point location)
 {
-    if(type == soldier_name_c) {
-        return shared_ptr<Agent>{new Soldier{name, location}};
-    }
-    else if(type == peasant_name_c) {
-        return shared_ptr<Agent>{new Peasant{name, location}};
-    }
-    else if(type == archer_name_c) {
-        return shared_ptr<Agent>{new Archer{name, location}};
+    shared_ptr<Agent> agent =
+        Agent_registry::create(type_name_hash(type.c_str()), type,
+                               name, location);
+    if(!agent) {
+        throw Error{"Trying to create agent of unknown type!"};
     }
-    else {
+    return agent;
+}
+
+//Looks the type up once, then makes all the Agents together
+vector<shared_ptr<Agent>>
+create_agents(const string& type, const vector<string>& names,
+              const vector<Point>& locations)
+{
+    vector<shared_ptr<Agent>> agents;
+    if(!Agent_registry::create_many(type_name_hash(type.c_str()), type,
+                                    names, locations, agents)) {
         throw Error{"Trying to create agent of unknown type!"};
     }
+    return agents;
 }
@@ -2,6 +2,7 @@
 #define AGENT_FACTORY_H
 
 #include <string>
+#include <vector>
 #include <memory>
 
 struct Point;
@@ -11,4 +12,12 @@ class Agent;
 // is unrecognized, throws Error("Trying to create agent of unknown type!")
 std::shared_ptr<Agent> create_agent(const std::string& name, const std::string& type, Point location);
 
+// Create one Agent of the specified type for each name, at the location with
+// the same index, in a single shared block of memory. names and locations
+// must be the same length. If the type is unrecognized,
+// throws Error("Trying to create agent of unknown type!")
+std::vector<std::shared_ptr<Agent>>
+create_agents(const std::string& type, const std::vector<std::string>& names,
+              const std::vector<Point>& locations);
+
 #endif
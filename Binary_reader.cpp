@@ -0,0 +1,64 @@
+#include "Binary_reader.h"
+#include "Utility.h"
+#include <fstream>
+#include <cstring>//memcpy
+
+using std::string;
+using std::ios;
+
+//Finds the size first, so the buffer is only allocated once
+Binary_reader::Binary_reader(const string& filename) : position(0)
+{
+    std::ifstream file(filename.c_str(), ios::in | ios::binary | ios::ate);
+    if(!file) {
+        throw Error{"Could not open input file!"};
+    }
+    std::streamoff size = file.tellg();
+    file.seekg(0);
+    buffer.resize(static_cast<std::size_t>(size));
+    if(!file.read(buffer.data(), size)) {
+        throw Error{"Could not open input file!"};
+    }
+}
+
+//Strings are read as a length followed by the characters
+string Binary_reader::get_string()
+{
+    uint16_t length = get<uint16_t>();
+    if(buffer.size() - position < length) {
+        throw Error{"Unexpected end of file!"};
+    }
+    string str(buffer.data() + position, length);
+    position += length;
+    return str;
+}
+
+//Checks there is enough left before copying
+void Binary_reader::take(void* data, std::size_t length)
+{
+    if(buffer.size() - position < length) {
+        throw Error{"Unexpected end of file!"};
+    }
+    std::memcpy(data, buffer.data() + position, length);
+    position += length;
+}
+
+//Compares without moving the position
+bool Binary_reader::ends_with(const void* data, std::size_t length) const
+{
+    return buffer.size() >= length &&
+        std::memcmp(buffer.data() + buffer.size() - length, data, length) == 0;
+}
+
+//Skips the zeros Binary_writer::pad_to wrote
+void Binary_reader::skip_to(std::size_t alignment)
+{
+    std::size_t remainder = position % alignment;
+    if(remainder != 0) {
+        std::size_t padding = alignment - remainder;
+        if(buffer.size() - position < padding) {
+            throw Error{"Unexpected end of file!"};
+        }
+        position += padding;
+    }
+}
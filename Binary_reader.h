@@ -0,0 +1,50 @@
+/*
+Binary_reader reads back values written by Binary_writer. The whole file is
+read into memory when it is opened, so taking a value out costs no more than
+copying its bytes, and a file that has been cut short is found out as soon
+as a value is missing, rather than by reading garbage.
+*/
+#ifndef BINARY_READER_H
+#define BINARY_READER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class Binary_reader {
+public:
+    //Reads the whole file into memory.
+    //Throws Error("Could not open input file!") if it can't.
+    Binary_reader(const std::string& filename);
+
+    //Takes the bytes of a plain value
+    template<typename T>
+    T get()
+    {
+        T value;
+        take(&value, sizeof(T));
+        return value;
+    }
+
+    //Takes a length as a uint16_t, then that many characters
+    std::string get_string();
+
+    //Takes a block of raw bytes.
+    //Throws Error("Unexpected end of file!") if there are not enough left.
+    void take(void* data, std::size_t length);
+
+    //Skips bytes until the total taken is a multiple of alignment
+    void skip_to(std::size_t alignment);
+
+    //returns true if the file's last bytes are the ones given
+    bool ends_with(const void* data, std::size_t length) const;
+
+    //Returns the total number of bytes in the file
+    std::size_t get_size() const {return buffer.size();}
+
+private:
+    std::vector<char> buffer;
+    std::size_t position;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "Binary_writer.h"
+#include "Utility.h"
+
+using std::string;
+using std::ios;
+
+//the buffer is written out whenever it grows past this many bytes
+const std::size_t binary_batch_size_c = 1 << 16;
+
+//Opens the file in binary mode and reserves the buffer
+Binary_writer::Binary_writer(const string& filename) :
+file(filename.c_str(), ios::out | ios::binary | ios::trunc), position(0)
+{
+    if(!file) {
+        throw Error{"Could not open output file!"};
+    }
+    buffer.reserve(binary_batch_size_c * 2);
+}
+
+//Writes out whatever is left
+Binary_writer::~Binary_writer()
+{
+    flush();
+}
+
+//Strings are written as a length followed by the characters
+void Binary_writer::put_string(const string& str)
+{
+    put(static_cast<uint16_t>(str.size()));
+    append(str.data(), str.size());
+}
+
+//Copies the bytes into the buffer, writing the batch out if it is full
+void Binary_writer::append(const void* data, std::size_t length)
+{
+    const char* bytes = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + length);
+    position += length;
+    if(buffer.size() >= binary_batch_size_c) {
+        file.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+//Pads with zeros so whatever comes next starts on a multiple of alignment
+void Binary_writer::pad_to(std::size_t alignment)
+{
+    std::size_t remainder = position % alignment;
+    if(remainder != 0) {
+        buffer.insert(buffer.end(), alignment - remainder, 0);
+        position += alignment - remainder;
+    }
+}
+
+//Writes out the buffer and flushes the file
+void Binary_writer::flush()
+{
+    if(!buffer.empty()) {
+        file.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    file.flush();
+}
@@ -0,0 +1,58 @@
+/*
+Binary_writer appends raw binary values to a file or pipe. Values are
+collected in a memory buffer and written out in large batches, so writing
+a record costs little more than copying its bytes. Numbers are written in
+the machine's own byte order; every file written by this program starts
+with a header that lets a reader check it.
+*/
+#ifndef BINARY_WRITER_H
+#define BINARY_WRITER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+class Binary_writer {
+public:
+    //Opens the file for writing, replacing anything already there.
+    //Throws Error("Could not open output file!") if it can't.
+    Binary_writer(const std::string& filename);
+    //Writes out anything still buffered
+    ~Binary_writer();
+
+    //Appends the bytes of a plain value
+    template<typename T>
+    void put(const T& value)
+    {
+        append(&value, sizeof(T));
+    }
+
+    //Appends the length of the string as a uint16_t, then its characters
+    void put_string(const std::string& str);
+
+    //Appends a block of raw bytes
+    void append(const void* data, std::size_t length);
+
+    //Appends zero bytes until the total written is a multiple of alignment
+    void pad_to(std::size_t alignment);
+
+    //Returns the total number of bytes appended so far
+    std::size_t get_position() const {return position;}
+
+    //Writes everything buffered so far and flushes the file
+    void flush();
+
+private:
+    std::ofstream file;
+    std::vector<char> buffer;
+    std::size_t position;
+
+	// disallow copy/move construction or assignment
+	Binary_writer(const Binary_writer&) = delete;
+	Binary_writer& operator= (const Binary_writer&)  = delete;
+	Binary_writer(Binary_writer&&) = delete;
+	Binary_writer& operator= (Binary_writer&&) = delete;
+};
+
+#endif
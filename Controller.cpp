@@ -2,29 +2,47 @@
 #include "Model.h"
 #include "View.h"
 #include "Views.h"
+#include "Telemetry_view.h"
+#include "Stats_view.h"
+#include "Heatmap_view.h"
+#include "History_view.h"
 #include "Agent_factory.h"
 #include "Structure_factory.h"
 #include "Utility.h"
 #include "Agent.h"
-#include <iostream>//cout, endl
+#include "Geometry.h"
+#include "Location_store.h"
+#include "Journal.h"
+#include <iostream>//output, endl
 #include <string>
 #include <map>//for map
+#include <set>//for group membership
 #include <functional>//for bind!
 #include <utility>//make_pair
 #include <cctype>//alphanum
-#include <algorithm>//any_of
+#include <algorithm>//any_of, sort
 #include <memory>
+#include <vector>
+#include <cmath>//ceil, sqrt, fabs
+#include <stdexcept>//logic_error
+#include <fstream>//fork scripts and output
+#include <thread>//fork variants
+#include <sstream>//replaying journal segments
+#include <cstdio>//remove
 
 using std::string;
 using std::map;
 using std::function;
-using std::cin;
 using std::bind;
 using std::exception;
-using std::cout;
 using std::endl;
 using std::any_of;
 using std::shared_ptr;
+using std::vector;
+using std::set;
+using std::weak_ptr;
+using std::sort;
+using std::to_string;
 using std::dynamic_pointer_cast;
 using namespace std::placeholders;
 
@@ -34,24 +52,143 @@ const char* const error_reading_int_c = "Expected an integer!";
 const int min_str_size_c = 2;
 const char* const bad_object_name_error_c = "Invalid name for new object!";
 const char* const map_unopened_c = "No map view is open!";
+const char* const async_rendering_c = "async";
+const char* const sync_rendering_c = "sync";
+const char* const trace_off_c = "off";
+const char* const trace_every_c = "every";
+const char* const bad_count_error_c = "Count must be positive!";
+const char* const group_by_names_c = "names";
+const char* const group_by_type_c = "type";
+const char* const group_by_region_c = "region";
+const char* const group_move_c = "move";
+const char* const group_work_c = "work";
+const char* const group_attack_c = "attack";
+const char* const group_stop_c = "stop";
+const char* const work_auto_off_c = "off";
+const char* const budget_off_c = "off";
+const char* const budget_stats_c = "stats";
+const char* const terminal_ansi_c = "ansi";
+const char* const terminal_plain_c = "plain";
+const char* const rank_lowest_c = "lowest";
+const char* const rank_highest_c = "highest";
+const char* const journal_off_c = "off";
+const char* const snapshot_suffix_c = ".snap";
+const char* const segment_suffix_c = ".journal.";
+const char* const rank_all_c = "all";
+const char* const filter_prefix_c = "prefix";
+const char* const filter_type_c = "type";
+const char* const filter_none_c = "none";
+const char* const heatmap_size_c = "size";
+const char* const heatmap_zoom_c = "zoom";
+const char* const heatmap_pan_c = "pan";
+const char* const heatmap_default_c = "default";
+const char* const history_full_c = "full";
+const char* const fork_output_suffix_c = ".out";
 
 //skips input until the first new_line character
-void skip_Input_Line();
+void skip_Input_Line(std::istream& input);
 
-//Reads in a name from stdin, throwing an error if the name is not a valid one
-string read_new_name();
+//Reads in a name from the input, throwing an error if the name is not a
+//valid one
+string read_new_name(const Model& model, std::istream& input);
 
-//Reads in a point from stdin, by reading x and then y doubles.
+//Returns true if the name is long enough and only letters and numbers
+bool is_valid_name(const string& name);
+
+//Returns how many columns a grid of count points should have so that its
+//cells are roughly square over a rectangle of the given width and height
+int grid_columns(int count, double width, double height);
+
+//Reads words from the input until the end of the line, leaving the newline
+vector<string> read_rest_of_line(std::istream& input);
+
+//Returns the living agent nearest the given one whose name isn't excluded,
+//or nullptr if there is none
+shared_ptr<Agent> find_nearest_agent(const Model& model,
+                                     shared_ptr<Agent> agent,
+                                     const set<string>& excluded);
+
+//Reads in a point from the input, by reading x and then y doubles.
 //Throws an error if unable to read doubles.
-Point get_Point();
+Point get_Point(std::istream& input);
 
 //Returns a pointer to a map_view if one exists
 //If one doesn't exist, throws an error indicating such
-shared_ptr<Map_view> get_map();
+shared_ptr<Map_view> get_map(Model& model);
+
+//Reads a view name and returns the Info_view of that name.
+//Throws an error if there is no such view or it isn't an Info_view.
+shared_ptr<Info_view> read_info_view(Model& model, std::istream& input);
+
+//Checks that every is "every", then reads the number of ticks after it.
+//Throws an error if either is missing or the number isn't positive.
+int read_trace_interval(const string& every, std::istream& input);
+
+//Gives the terminal back to scrolling output if the map is drawing for an
+//ANSI one, once any frames still being drawn have been written
+void release_map_terminal(Model& model, Map_view& view);
+
+//Returns the name of the snapshot file kept with the journal of that name
+string snapshot_name(const string& prefix);
+
+//Returns the name of a segment of the journal of that name
+string segment_name(const string& prefix, int segment);
+
+//Returns true if the file can be opened for reading
+bool file_exists(const string& filename);
+
+//Deletes the segments of the named journal from first up to, but not
+//including, last
+void remove_segments(const string& prefix, int first, int last);
+
+//Where commands are journaled, and which segments are on disk. The
+//snapshot tagged with a segment's number holds the world as it was when
+//that segment was started.
+struct Controller::Journaling {
+    string prefix;
+    int interval;//ticks between snapshots
+    int segment;//the segment being appended to
+    int oldest_segment;//the oldest segment still on disk
+    int snapshot_time;//when the latest snapshot was started
+    std::unique_ptr<Journal> journal;
+};
+
+//Makes the initial world; it and its views go when the Controller does
+Controller::Controller() : own_model(new Model), model(*own_model),
+recorder(new Input_recorder(std::cin.rdbuf())), input(recorder.get()),
+output(model.get_output())
+{
+    input.tie(std::cin.tie());//the prompt still appears before reading
+}
+//Leaves the world to whoever made it
+Controller::Controller(Model& model_, std::istream& input_) :
+model(model_), recorder(new Input_recorder(input_.rdbuf())),
+input(recorder.get()), output(model_.get_output())
+{
+    input.tie(input_.tie());
+}
+//Declared here so Model, Input_recorder and Journaling are complete when
+//destroyed; whatever has been journaled is committed
+Controller::~Controller()
+{
+}
+
+//One what-if run started by fork: its script, its output, and its world
+struct Variant {
+    string script;
+    std::ifstream input;
+    std::ofstream output;
+    std::unique_ptr<Model> world;
+    string error;//what stopped it early, if anything
+};
+
+//Runs the script against the variant's world, then lets the world carry
+//on for the given number of ticks. Runs on the variant's own thread.
+void run_variant(Variant& variant, int ticks);
 
 //Runs an infinite loop processing user commands.
-//When the user eventually quits, deletes the view it instantiated
-//and sent to Model.
+//When the user eventually quits, or the input runs out, deletes the view
+//it instantiated and sent to Model.
 void Controller::run()
 {
     //set up maps of commands-to-functions:
@@ -67,14 +204,62 @@ void Controller::run()
     command_fcns.insert(make_pair("default",
                                   bind(&Controller::set_default_map, this)));
     command_fcns.insert(make_pair("show", bind(&Controller::draw, this)));
+    command_fcns.insert(make_pair("trace",
+                                  bind(&Controller::set_trace, this)));
+    command_fcns.insert(make_pair("trace-hash",
+                                  bind(&Controller::set_hash_trace, this)));
+    command_fcns.insert(make_pair("render",
+                                  bind(&Controller::set_rendering, this)));
+    command_fcns.insert(make_pair("budget",
+                                  bind(&Controller::set_budget, this)));
+    command_fcns.insert(make_pair("refresh",
+                                  bind(&Controller::set_refresh, this)));
+    command_fcns.insert(make_pair("top", bind(&Controller::set_top, this)));
+    command_fcns.insert(make_pair("filter",
+                                  bind(&Controller::set_filter, this)));
     command_fcns.insert(make_pair("close", bind(&Controller::close, this)));
     command_fcns.insert(make_pair("size",
                                   bind(&Controller::resize, this)));
     command_fcns.insert(make_pair("zoom",
                                   bind(&Controller::zoom, this)));
     command_fcns.insert(make_pair("pan", bind(&Controller::pan, this)));
+    command_fcns.insert(make_pair("heatmap",
+                                  bind(&Controller::adjust_heatmap, this)));
+    command_fcns.insert(make_pair("history",
+                                  bind(&Controller::show_history, this)));
+    command_fcns.insert(make_pair("snapshot-image",
+                                  bind(&Controller::snapshot_image, this)));
+    command_fcns.insert(make_pair("terminal",
+                                  bind(&Controller::set_terminal, this)));
     command_fcns.insert(make_pair("build", bind(&Controller::build, this)));
     command_fcns.insert(make_pair("train", bind(&Controller::train, this)));
+    command_fcns.insert(make_pair("build-many",
+                                  bind(&Controller::build_many, this)));
+    command_fcns.insert(make_pair("train-many",
+                                  bind(&Controller::train_many, this)));
+    command_fcns.insert(make_pair("group",
+                                  bind(&Controller::define_group, this)));
+    command_fcns.insert(make_pair("ungroup",
+                                  bind(&Controller::disband_group, this)));
+    command_fcns.insert(make_pair("order",
+                                  bind(&Controller::order_group, this)));
+    command_fcns.insert(make_pair("work-auto",
+                                  bind(&Controller::work_auto, this)));
+    command_fcns.insert(make_pair("fork", bind(&Controller::fork, this)));
+    command_fcns.insert(make_pair("checkpoint",
+                                  bind(&Controller::set_checkpoint, this)));
+    command_fcns.insert(make_pair("rewind",
+                                  bind(&Controller::rewind, this)));
+    command_fcns.insert(make_pair("hash",
+                                  bind(&Controller::show_hash, this)));
+    command_fcns.insert(make_pair("journal",
+                                  bind(&Controller::set_journal, this)));
+    command_fcns.insert(make_pair("recover",
+                                  bind(&Controller::recover, this)));
+    //the commands that change the world, and so are journaled, besides
+    //every agent command; rewinding takes a snapshot instead
+    set<string> journaled_cmds{"go", "build", "train", "build-many",
+        "train-many", "group", "ungroup", "order", "work-auto"};
     
     //the following require an agent's name to be read in before being called:
     agent_fcns.insert(make_pair("move", bind(&Controller::move,
@@ -87,26 +272,36 @@ void Controller::run()
     
     while(true) {//run until "quit" has been read
         try {
-            cout << "\nTime " << Model::get_instance().get_time()<< ": Enter command: ";
+            output << "\nTime " << model.get_time()<< ": Enter command: ";
+            recorder->clear();
             string cmd;
-            cin >> cmd;
-            if(cmd == exit_cmd_c) {
-                cout << "Done" << endl;
+            input >> cmd;
+            if(cmd == exit_cmd_c || (!input && input.eof())) {
+                //let any pending output finish before we say goodbye
+                stop_journal();
+                model.set_async_drawing(false);
+                if(model.has_view(map_view_name_c)) {
+                    get_map(model)->release_terminal(output);
+                }
+                output << "Done" << endl;
                 return;//so let's abort
             }
-            else if(Model::get_instance().is_agent_present(cmd)) {
+            else if(model.is_agent_present(cmd)) {
                 //in other words, if the input is an agent
                 shared_ptr<Agent> agent =
-                Model::get_instance().get_agent_ptr(cmd);
+                model.get_agent_ptr(cmd);
                 if(!agent->is_alive()) {
                     throw Error{"Agent is dead!"};
                 }
-                cin >> cmd;
+                input >> cmd;
                 auto fcn = agent_fcns.find(cmd);
                 if(fcn == agent_fcns.end()) {
                     throw Error{"Unrecognized command!"};
                 }
                 fcn->second(agent);//if all is well, call agent's fcn
+                if(journaling) {
+                    journal_command();
+                }
             }
             else {
                 auto fcn_cmd = command_fcns.find(cmd);
@@ -114,15 +309,18 @@ void Controller::run()
                     throw Error{"Unrecognized command!"};
                 }
                 fcn_cmd->second();
+                if(journaling && journaled_cmds.count(cmd)) {
+                    journal_command();
+                }
             }
         }
         catch(exception& error) {
-            cout << error.what() << endl;
-            skip_Input_Line();
+            output << error.what() << endl;
+            skip_Input_Line(input);
         }
         catch(...) {
-            cout << "Unknown exception caught!" << endl;
-            skip_Input_Line();
+            output << "Unknown exception caught!" << endl;
+            skip_Input_Line(input);
         }
     }
 }
@@ -131,19 +329,28 @@ void Controller::run()
 void Controller::open()
 {
     string type_of_view;
-    cin >> type_of_view;
-    if(Model::get_instance().has_view(type_of_view)) {
+    input >> type_of_view;
+    if(model.has_view(type_of_view)) {
         throw Error{"View of that name already open!"};
     }
     if(type_of_view == map_view_name_c) {
-        Model::get_instance().attach(shared_ptr<View>{new Map_view});
+        model.attach(shared_ptr<View>{new Map_view{model}});
     } else if(type_of_view == health_view_name_c) {
-        Model::get_instance().attach(shared_ptr<View>{new Health_view});
+        model.attach(shared_ptr<View>{new Health_view{model}});
     } else if(type_of_view == amounts_view_name_c) {
-        Model::get_instance().attach(shared_ptr<View>{new Amount_view});
-    } else if(Model::get_instance().is_name_in_use(type_of_view)) {
-        Model::get_instance().attach(
-                                     shared_ptr<View>{ new Local_view{type_of_view}});
+        model.attach(shared_ptr<View>{new Amount_view{model}});
+    } else if(type_of_view == heatmap_view_name_c) {
+        model.attach(shared_ptr<View>{new Heatmap_view{model}});
+    } else if(type_of_view == history_view_name_c) {
+        model.attach(shared_ptr<View>{new History_view{model}});
+    } else if(type_of_view == stats_view_name_c) {
+        model.attach(shared_ptr<View>{new Stats_view{model}});
+    } else if(type_of_view == telemetry_view_name_c) {
+        string filename;
+        input >> filename;
+        model.attach(shared_ptr<View>{new Telemetry_view{model, filename}});
+    } else if(model.is_name_in_use(type_of_view)) {
+        model.attach(shared_ptr<View>{new Local_view{model, type_of_view}});
     } else {
         throw Error{"No object of that name!"};
     }
@@ -153,31 +360,119 @@ void Controller::open()
 void Controller::close()
 {
     string type_of_view;
-    cin >> type_of_view;
-    shared_ptr<View> view = Model::get_instance().get_view(type_of_view);
+    input >> type_of_view;
+    shared_ptr<View> view = model.get_view(type_of_view);
+    if(view == nullptr) {
+        throw Error{"No view of that name is open!"};
+    }
+    model.detach(view);
+    shared_ptr<Map_view> map = dynamic_pointer_cast<Map_view>(view);
+    if(map) {
+        release_map_terminal(model, *map);
+    }
+}
+
+//Reads a view name and the fewest ticks between its redraws.
+//If the user gave bad information, throws the relevant error.
+void Controller::set_refresh()
+{
+    string view_name;
+    input >> view_name;
+    shared_ptr<View> view = model.get_view(view_name);
+    if(view == nullptr) {
+        throw Error{"No view of that name is open!"};
+    }
+    int ticks;
+    input >> ticks;
+    if(!input) {
+        throw Error{error_reading_int_c};
+    }
+    view->set_refresh_interval(ticks);
+}
+
+//Reads "lowest" or "highest" and a count, or "all".
+//If the user gave bad information, throws the relevant error.
+void Controller::set_top()
+{
+    shared_ptr<Info_view> view = read_info_view(model, input);
+    string order;
+    input >> order;
+    if(order == rank_all_c) {
+        view->set_ranking(Info_view::UNRANKED, 0);
+        return;
+    }
+    Info_view::Ranking_e ranking;
+    if(order == rank_lowest_c) {
+        ranking = Info_view::LOWEST_FIRST;
+    } else if(order == rank_highest_c) {
+        ranking = Info_view::HIGHEST_FIRST;
+    } else {
+        throw Error{"Expected lowest, highest or all!"};
+    }
+    int count;
+    input >> count;
+    if(!input) {
+        throw Error{error_reading_int_c};
+    }
+    view->set_ranking(ranking, count);
+}
+
+//Reads "prefix" and a name prefix, "type" and a type name, or "none".
+//Throws an error if it is none of those.
+void Controller::set_filter()
+{
+    shared_ptr<Info_view> view = read_info_view(model, input);
+    string selector;
+    input >> selector;
+    if(selector == filter_prefix_c) {
+        string prefix;
+        input >> prefix;
+        view->set_name_filter(prefix);
+    } else if(selector == filter_type_c) {
+        string type;
+        input >> type;
+        view->set_type_filter(type);
+    } else if(selector == filter_none_c) {
+        view->set_name_filter("");
+        view->set_type_filter("");
+    } else {
+        throw Error{"Expected prefix, type or none!"};
+    }
+}
+
+//Looks the view up and checks that it shows data about each object
+shared_ptr<Info_view> read_info_view(Model& model, std::istream& input)
+{
+    string view_name;
+    input >> view_name;
+    shared_ptr<View> view = model.get_view(view_name);
     if(view == nullptr) {
         throw Error{"No view of that name is open!"};
     }
-    Model::get_instance().detach(view);
+    shared_ptr<Info_view> info_view = dynamic_pointer_cast<Info_view>(view);
+    if(info_view == nullptr) {
+        throw Error{"That view does not show data about each object!"};
+    }
+    return info_view;
 }
 
 //Reads an integer "size" and calls view's set_size with the read in value
 //Throws an error if unable to read an integer
 void Controller::resize()
 {
-    shared_ptr<Map_view> view = get_map();
+    shared_ptr<Map_view> view = get_map(model);
     int size;
-    cin >> size;
-    if(!cin) {
+    input >> size;
+    if(!input) {
         throw Error{error_reading_int_c};
     }
     view->set_size(size);
 }
 //Returns the map if one exists. If one doesn't exist, throws an error. 
-shared_ptr<Map_view> get_map()
+shared_ptr<Map_view> get_map(Model& model)
 {
     shared_ptr<Map_view> view =
-    dynamic_pointer_cast<Map_view>(Model::get_instance().get_view(map_view_name_c));
+    dynamic_pointer_cast<Map_view>(model.get_view(map_view_name_c));
     if(view == nullptr) {
         throw Error{map_unopened_c};
     }
@@ -188,10 +483,10 @@ shared_ptr<Map_view> get_map()
 //Throws an error if unable to read a double.
 void Controller::zoom()
 {
-    shared_ptr<Map_view> view = get_map();
+    shared_ptr<Map_view> view = get_map(model);
     double zoom_val;
-    cin >> zoom_val;
-    if(!cin) {
+    input >> zoom_val;
+    if(!input) {
         throw Error{error_reading_double_c};
     }
     view->set_scale(zoom_val);
@@ -200,30 +495,418 @@ void Controller::zoom()
 //Throws an error if unable to read doubles.
 void Controller::pan()
 {
-    get_map()->set_origin(get_Point());//can just construct point in-place
+    //can just construct point in-place
+    get_map(model)->set_origin(get_Point(input));
+}
+
+//Reads which of the heatmap's settings to change, and then its new value
+//the same way size, zoom and pan do for the map.
+//If the user gave bad information, throws the relevant error.
+void Controller::adjust_heatmap()
+{
+    shared_ptr<Heatmap_view> view = dynamic_pointer_cast<Heatmap_view>(
+        model.get_view(heatmap_view_name_c));
+    if(view == nullptr) {
+        throw Error{"No heatmap view is open!"};
+    }
+    string setting;
+    input >> setting;
+    if(setting == heatmap_size_c) {
+        int size;
+        input >> size;
+        if(!input) {
+            throw Error{error_reading_int_c};
+        }
+        view->set_size(size);
+    } else if(setting == heatmap_zoom_c) {
+        double zoom_val;
+        input >> zoom_val;
+        if(!input) {
+            throw Error{error_reading_double_c};
+        }
+        view->set_scale(zoom_val);
+    } else if(setting == heatmap_pan_c) {
+        view->set_origin(get_Point(input));
+    } else if(setting == heatmap_default_c) {
+        view->set_defaults();
+    } else {
+        throw Error{"Expected size, zoom, pan or default!"};
+    }
+}
+
+//Reads an object's name, and optionally "full" to list every sample.
+//If there is no history view or the input is bad, throws an error.
+void Controller::show_history()
+{
+    shared_ptr<History_view> view = dynamic_pointer_cast<History_view>(
+        model.get_view(history_view_name_c));
+    if(view == nullptr) {
+        throw Error{"No history view is open!"};
+    }
+    string name;
+    input >> name;
+    vector<string> options = read_rest_of_line(input);
+    bool full = false;
+    if(options.size() == 1 && options.front() == history_full_c) {
+        full = true;
+    } else if(!options.empty()) {
+        throw Error{"Expected full or nothing after the name!"};
+    }
+    view->describe(name, full, output);
+}
+
+//Reads a file name and the width and height of the image in pixels.
+//If the user gave bad information, throws the relevant error.
+void Controller::snapshot_image()
+{
+    string filename;
+    input >> filename;
+    int width, height;
+    input >> width >> height;
+    if(!input) {
+        throw Error{error_reading_int_c};
+    }
+    model.write_image(filename, width, height);
+}
+
+//Reads "ansi" or "plain" and has the map draw itself accordingly.
+//Throws an error if the mode is not recognized.
+void Controller::set_terminal()
+{
+    shared_ptr<Map_view> view = get_map(model);
+    string mode;
+    input >> mode;
+    if(mode == terminal_ansi_c) {
+        view->set_ansi(true);
+    } else if(mode == terminal_plain_c) {
+        release_map_terminal(model, *view);
+        view->set_ansi(false);
+    } else {
+        throw Error{"Expected ansi or plain!"};
+    }
 }
 
 //Sets the map's defaults
 void Controller::set_default_map()
 {
-    get_map()->set_defaults();
+    get_map(model)->set_defaults();
 }
 
 //Has the Model render all of the views currently available
 void Controller::draw()
 {
-    Model::get_instance().draw();
+    model.draw();
 }
 
+//Switches between drawing on a render thread and drawing right here.
+//Throws an error if the mode is not recognized.
+void Controller::set_rendering()
+{
+    string mode;
+    input >> mode;
+    if(mode == async_rendering_c) {
+        model.set_async_drawing(true);
+    } else if(mode == sync_rendering_c) {
+        model.set_async_drawing(false);
+    } else {
+        throw Error{"Expected async or sync!"};
+    }
+}
+
+//Reads "off", "stats", or a positive number of microseconds.
+//Throws an error if it is none of those. How much fits in a budget depends
+//on the clock, so replaying a journal could not do the same work each tick;
+//a budget can't be set while journaling.
+void Controller::set_budget()
+{
+    string budget_str;
+    input >> budget_str;
+    if(budget_str == budget_off_c) {
+        model.set_task_budget(0);
+        return;
+    }
+    if(budget_str == budget_stats_c) {
+        model.describe_tasks();
+        return;
+    }
+    int budget;
+    try {
+        std::size_t used;
+        budget = std::stoi(budget_str, &used);
+        if(used != budget_str.length()) {
+            throw Error{error_reading_int_c};
+        }
+    }
+    catch(std::logic_error&) {//stoi's invalid_argument and out_of_range
+        throw Error{error_reading_int_c};
+    }
+    if(budget <= 0) {
+        throw Error{"Budget must be positive!"};
+    }
+    if(journaling) {
+        throw Error{"Cannot set a budget while journaling!"};
+    }
+    model.set_task_budget(budget);
+}
 //Has the Model describe all objects currently in existence.
 void Controller::describe()
 {
-    Model::get_instance().describe();
+    model.describe();
 }
 //Has the Model update all objects in existence.
 void Controller::update()
 {
-    Model::get_instance().update();
+    model.update();
+}
+
+//Any word will do as a label
+void Controller::set_checkpoint()
+{
+    string label;
+    input >> label;
+    model.checkpoint(label);
+}
+//Groups keep their members, since agents that come back are the same agents.
+//The journal can't replay a rewind, so the world is snapshotted instead;
+//the segment being retired is committed first, so it is whole on disk
+//before the world it describes is gone. If the snapshot can't be written,
+//the journal would recover as if the rewind never happened, so journaling
+//stops, and whatever was started after that segment is deleted; the files
+//left recover the world as it was just before the rewind.
+void Controller::rewind()
+{
+    string label;
+    input >> label;
+    if(journaling) {
+        journaling->journal->sync();
+    }
+    model.rewind(label);
+    work_auto_command.clear();//the plan has been stopped
+    if(!journaling) {
+        return;
+    }
+    int retired_segment = journaling->segment;
+    try {
+        take_snapshot(true);
+    }
+    catch(exception& error) {
+        std::unique_ptr<Journaling> stopped(journaling.release());
+        stopped->journal.reset();
+        remove_segments(stopped->prefix, retired_segment + 1,
+                        stopped->segment + 1);
+        throw Error{string(error.what()) + " Journaling stopped!"};
+    }
+}
+
+//Files from an earlier journal of the same name are removed first, so
+//its segments can't be mistaken for this one's. The first snapshot is
+//written before anything is journaled.
+void Controller::set_journal()
+{
+    string prefix;
+    input >> prefix;
+    if(prefix == journal_off_c) {
+        stop_journal();
+        return;
+    }
+    string every;
+    input >> every;
+    if(every != trace_every_c) {
+        throw Error{"Expected every!"};
+    }
+    int interval;
+    input >> interval;
+    if(!input) {
+        throw Error{error_reading_int_c};
+    }
+    if(interval <= 0) {
+        throw Error{"Snapshot interval must be positive!"};
+    }
+    if(model.get_task_budget() > 0) {
+        throw Error{"Cannot journal with a task budget!"};
+    }
+    stop_journal();
+    int first_old = 1;
+    if(file_exists(snapshot_name(prefix))) {
+        first_old = Model::read_snapshot_tag(snapshot_name(prefix));
+    }
+    for(int old = first_old; file_exists(segment_name(prefix, old)); old++) {
+        std::remove(segment_name(prefix, old).c_str());
+    }
+    model.write_snapshot(snapshot_name(prefix), 1);
+    journaling.reset(new Journaling{prefix, interval, 1, 1, model.get_time(),
+        std::unique_ptr<Journal>(new Journal(segment_name(prefix, 1)))});
+    journal_controller_state();
+}
+
+//Groups name agents of the old world, so they are only kept if the
+//journal recreates them
+void Controller::recover()
+{
+    string prefix;
+    input >> prefix;
+    if(journaling) {
+        throw Error{"Cannot recover while journaling!"};
+    }
+    int segment = model.read_snapshot(snapshot_name(prefix));
+    groups.clear();
+    work_auto_command.clear();
+    int replayed = 0;
+    for(; file_exists(segment_name(prefix, segment)); segment++) {
+        replayed += replay_segment(segment_name(prefix, segment));
+    }
+    output << "Recovered to time " << model.get_time() << " with "
+        << replayed << " commands replayed" << endl;
+}
+
+//Leading and trailing blanks are dropped, and a command typed over several
+//lines is journaled on one
+void Controller::journal_command()
+{
+    string record = recorder->get_recorded();
+    std::replace(record.begin(), record.end(), '\n', ' ');
+    auto first = record.find_first_not_of(" \t\r");
+    auto last = record.find_last_not_of(" \t\r");
+    journaling->journal->append(record.substr(first, last - first + 1));
+    if(journaling->oldest_segment < journaling->segment &&
+       !model.is_writing_snapshot()) {
+        remove_old_segments();
+    }
+    if(model.get_time() - journaling->snapshot_time >= journaling->interval) {
+        take_snapshot(false);
+    }
+}
+
+//The old segment is committed before any command goes in the new one.
+//If a snapshot is still being written, the next command will try again,
+//so the tick never waits for the disk.
+void Controller::take_snapshot(bool wait)
+{
+    if(model.is_writing_snapshot() && !wait) {
+        return;
+    }
+    remove_old_segments();
+    int next_segment = journaling->segment + 1;
+    std::unique_ptr<Journal> next_journal(
+        new Journal(segment_name(journaling->prefix, next_segment)));
+    journaling->journal = std::move(next_journal);
+    journaling->segment = next_segment;
+    journal_controller_state();
+    journaling->snapshot_time = model.get_time();
+    model.start_snapshot(snapshot_name(journaling->prefix), next_segment);
+    if(wait) {
+        remove_old_segments();
+    }
+}
+
+//Until the snapshot has been written, recovering still needs the old
+//segments, so nothing is removed if it failed
+void Controller::remove_old_segments()
+{
+    model.finish_snapshot();
+    remove_segments(journaling->prefix, journaling->oldest_segment,
+                    journaling->segment);
+    journaling->oldest_segment = journaling->segment;
+}
+
+//Groups are recreated by name, with only their living members. Restarting
+//automatic work plans it afresh.
+void Controller::journal_controller_state()
+{
+    for(const auto& group_pair : groups) {
+        string record = "group " + group_pair.first + " " + group_by_names_c;
+        int living = 0;
+        for(const weak_ptr<Agent>& member : group_pair.second) {
+            shared_ptr<Agent> agent = member.lock();
+            if(agent && agent->is_alive()) {
+                record += " " + agent->get_name();
+                living++;
+            }
+        }
+        if(living > 0) {
+            journaling->journal->append(record);
+        }
+    }
+    if(!work_auto_command.empty()) {
+        journaling->journal->append(work_auto_command);
+    }
+}
+
+//Nothing to do if not journaling. Journaling stops even if the last
+//snapshot failed, in which case the error is reported and the segments it
+//would have replaced are kept.
+void Controller::stop_journal()
+{
+    if(!journaling) {
+        return;
+    }
+    std::unique_ptr<Journaling> stopped(journaling.release());
+    stopped->journal.reset();
+    model.finish_snapshot();
+    remove_segments(stopped->prefix, stopped->oldest_segment,
+                    stopped->segment);
+}
+
+//A record cut short by a crash has no newline, and was never committed,
+//so it is left out. The segment is replayed by a Controller of its own,
+//which takes over the groups and hands them back. No render thread is left
+//holding the output while it is muted.
+int Controller::replay_segment(const string& filename)
+{
+    std::ifstream file(filename.c_str());
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    string text = contents.str();
+    text.erase(text.find_last_of('\n') + 1);
+    std::istringstream commands(text);
+    Controller replayer(model, commands);
+    replayer.groups = groups;
+    replayer.work_auto_command = work_auto_command;
+    bool async = model.is_drawing_async();
+    model.set_async_drawing(false);
+    {
+        Output_muter muter(output);
+        replayer.run();
+        model.set_async_drawing(false);
+    }
+    model.set_async_drawing(async);
+    groups = replayer.groups;
+    work_auto_command = replayer.work_auto_command;
+    return static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+}
+
+//Model formats the hash the same way for the hash trace
+void Controller::show_hash()
+{
+    model.describe_state_hash();
+}
+
+//Reads "off", or "<file> every <ticks>", and stops or starts the trace.
+//Throws an error if the input is malformed.
+void Controller::set_trace()
+{
+    string filename;
+    input >> filename;
+    if(filename == trace_off_c) {
+        model.stop_trace();
+        return;
+    }
+    string every;
+    input >> every;
+    model.start_trace(filename, read_trace_interval(every, input));
+}
+
+//Reads "off", or "every <ticks>", and stops or starts the hash trace.
+//Throws an error if the input is malformed.
+void Controller::set_hash_trace()
+{
+    string every;
+    input >> every;
+    if(every == trace_off_c) {
+        model.stop_hash_trace();
+        return;
+    }
+    model.start_hash_trace(read_trace_interval(every, input));
 }
 
 //Reads in the data for a new structure and adds it to the Model
@@ -231,89 +914,559 @@ void Controller::build()
 {
     New_object new_obj = create_object();
     shared_ptr<Structure> new_struct =
-    create_structure(new_obj.name, new_obj.type, get_Point());
-    Model::get_instance().add_structure(new_struct);
+    create_structure(new_obj.name, new_obj.type, get_Point(input));
+    model.add_structure(new_struct);
 }
 //Reads in and adds the data for a new agent to the Model.
 void Controller::train()
 {
     New_object new_obj = create_object();
     shared_ptr<Agent> new_agent =
-    create_agent(new_obj.name, new_obj.type, get_Point());
-    Model::get_instance().add_agent(new_agent);
+    create_agent(new_obj.name, new_obj.type, get_Point(input));
+    model.add_agent(new_agent);
+}
+//Reads in the data for many new structures and adds them to the Model
+//together, so the views hear about them once
+void Controller::build_many()
+{
+    New_objects new_objs = create_objects();
+    model.add_structures(
+        create_structures(new_objs.type, new_objs.names, new_objs.locations));
+}
+//Reads in the data for many new agents and adds them to the Model
+//together, so the views hear about them once
+void Controller::train_many()
+{
+    New_objects new_objs = create_objects();
+    model.add_agents(
+        create_agents(new_objs.type, new_objs.names, new_objs.locations));
 }
 //Reads in the necessary data for a generic new object,
 //verifying the name and doubles,
 //before returning it in a "New_object" struct
 Controller::New_object Controller::create_object() {
-    string new_name = read_new_name();
+    string new_name = read_new_name(model, input);
     string type;
-    cin >> type;
+    input >> type;
     return New_object{new_name, type};
 }
 
+//Names are the prefix followed by a number, zero-padded so that they sort
+//in the order they are made; locations fill the rectangle row by row, on
+//a grid shaped like the rectangle. Every name is checked before any
+//object is made, so a clash leaves the world untouched.
+Controller::New_objects Controller::create_objects() {
+    New_objects new_objs;
+    string prefix;
+    int count;
+    input >> new_objs.type >> prefix >> count;
+    if(!input) {
+        throw Error{error_reading_int_c};
+    }
+    if(count <= 0) {
+        throw Error{bad_count_error_c};
+    }
+    Point lower_left = get_Point(input);
+    Point upper_right = get_Point(input);
+    int columns = grid_columns(count, fabs(upper_right.x - lower_left.x),
+                               fabs(upper_right.y - lower_left.y));
+    int rows = (count + columns - 1) / columns;
+    double x_step = columns > 1 ?
+        (upper_right.x - lower_left.x) / (columns - 1) : 0.;
+    double y_step = rows > 1 ?
+        (upper_right.y - lower_left.y) / (rows - 1) : 0.;
+    string::size_type width = to_string(count).length();
+    new_objs.names.reserve(count);
+    new_objs.locations.reserve(count);
+    for(int i = 0; i < count; i++) {
+        string number = to_string(i + 1);
+        string name = prefix + string(width - number.length(), '0') + number;
+        if(!is_valid_name(name) ||
+           model.is_name_in_use(name)) {
+            throw Error{bad_object_name_error_c};
+        }
+        new_objs.names.push_back(name);
+        new_objs.locations.push_back(
+            Point{lower_left.x + (i % columns) * x_step,
+                  lower_left.y + (i / columns) * y_step});
+    }
+    return new_objs;
+}
+
+//A flat rectangle gets a single row or column; otherwise the columns
+//outnumber the rows by about the rectangle's aspect ratio
+int grid_columns(int count, double width, double height)
+{
+    if(height == 0.) {
+        return count;
+    }
+    if(width == 0.) {
+        return 1;
+    }
+    int columns = static_cast<int>(ceil(sqrt(count * width / height)));
+    return columns > count ? count : columns;
+}
+
 //Reads in a name for a new object, and throws an error if it
 //is not at least 2 chars and doesn't only consist of letters/number
-string read_new_name()
+string read_new_name(const Model& model, std::istream& input)
 {
     string new_name;
-    cin >> new_name;
-    if(new_name.length() < min_str_size_c) {
-        throw Error{bad_object_name_error_c};
-    }
-    if(any_of(new_name.begin(), new_name.end(), [](const char& c) {
-        return !isalnum(c);
-    })) {//if any character is not alphanumeric, throw error:
+    input >> new_name;
+    if(!is_valid_name(new_name)) {
         throw Error{bad_object_name_error_c};
     }
-    if(Model::get_instance().is_name_in_use(new_name)) {
+    if(model.is_name_in_use(new_name)) {
         throw Error{bad_object_name_error_c};
     }
     return new_name;
 }
 
-//Reads in x, y values from cin, and throws an error if it is not able to.
-Point get_Point()
+//A name must be at least 2 chars, all letters or numbers
+bool is_valid_name(const string& name)
+{
+    if(name.length() < min_str_size_c) {
+        return false;
+    }
+    return !any_of(name.begin(), name.end(), [](const char& c) {
+        return !isalnum(c);
+    });//if any character is not alphanumeric, it's not valid
+}
+
+//Reads in x, y values from input, and throws an error if it is not able to.
+Point get_Point(std::istream& input)
 {
     double x, y;
-    cin >> x >> y;
-    if(!cin) {
+    input >> x >> y;
+    if(!input) {
         throw Error{error_reading_double_c};
     }
     return Point{x, y};
 }
 
-//calls move_to and orders the agent to move to a location read from cin
+//calls move_to and orders the agent to move to a location read from input
 void Controller::move(shared_ptr<Agent> agent)
 {
-    agent->move_to(get_Point());
+    agent->move_to(get_Point(input));
 }
 //Reads in two structure names and orders the agent given to work with them.
 //An error is thrown if either structure doesn't exist.
 void Controller::work(shared_ptr<Agent> agent)
 {
     string source, dest;
-    cin >> source >> dest;
+    input >> source >> dest;
     agent->start_working(
-                         Model::get_instance().get_structure_ptr(source),
-                         Model::get_instance().get_structure_ptr(dest));
+                         model.get_structure_ptr(source),
+                         model.get_structure_ptr(dest));
 }
 //Reads in an agent name and orders the agent to begin attacking him.
 //An error is thrown if the target doesn't exist
 void Controller::attack(shared_ptr<Agent> agent)
 {
     string target;
-    cin >> target;
-    agent->start_attacking(Model::get_instance().get_agent_ptr(target));
+    input >> target;
+    agent->start_attacking(model.get_agent_ptr(target));
 }
 //Calls the agent's stop command.
 void Controller::stop(shared_ptr<Agent> agent)
 {
     agent->stop();
 }
-//clears any bad state cin has and reads characters until the next newline
-void skip_Input_Line()
+//Picks the group's agents by the selector read in; only living agents
+//are picked, each only once
+void Controller::define_group()
+{
+    string group_name;
+    input >> group_name;
+    if(!is_valid_name(group_name)) {
+        throw Error{"Invalid group name!"};
+    }
+    string selector;
+    input >> selector;
+    vector<shared_ptr<Agent>> picked;
+    if(selector == group_by_names_c) {
+        for(const string& name : read_rest_of_line(input)) {
+            picked.push_back(model.get_agent_ptr(name));
+        }
+    } else if(selector == group_by_type_c) {
+        string type;
+        input >> type;
+        for(shared_ptr<Agent> agent : model.get_all_agents()) {
+            if(type == agent->get_type_name()) {
+                picked.push_back(agent);
+            }
+        }
+    } else if(selector == group_by_region_c) {
+        Point corner1 = get_Point(input);
+        Point corner2 = get_Point(input);
+        Region region{Point{std::min(corner1.x, corner2.x),
+                            std::min(corner1.y, corner2.y)},
+                      Point{std::max(corner1.x, corner2.x),
+                            std::max(corner1.y, corner2.y)}};
+        for(const auto& located : model.get_location_store().
+            get_objects_in(region)) {
+            if(model.is_agent_present(located.first)) {
+                picked.push_back(
+                    model.get_agent_ptr(located.first));
+            }
+        }
+    } else {
+        throw Error{"Expected names, type or region!"};
+    }
+    vector<weak_ptr<Agent>> members;
+    set<string> member_names;
+    for(shared_ptr<Agent> agent : picked) {
+        if(agent->is_alive() && member_names.insert(agent->get_name()).second) {
+            members.push_back(agent);
+        }
+    }
+    if(members.empty()) {
+        throw Error{"No living agents picked!"};
+    }
+    groups[group_name] = members;
+    output << "Group " << group_name << ": " << members.size() << " agents"
+        << endl;
+}
+//Forgets the group; its agents are unaffected
+void Controller::disband_group()
+{
+    string group_name;
+    input >> group_name;
+    if(!groups.erase(group_name)) {
+        throw Error{"Group not found!"};
+    }
+}
+//Looks up every structure named before handing the plan over to Model
+void Controller::work_auto()
+{
+    string group_name;
+    input >> group_name;
+    if(group_name == work_auto_off_c) {
+        model.stop_logistics();
+        work_auto_command.clear();
+        return;
+    }
+    vector<shared_ptr<Agent>> members = get_group(group_name);
+    vector<string> structure_names = read_rest_of_line(input);
+    vector<shared_ptr<Structure>> structures;
+    if(structure_names.empty()) {
+        structures = model.get_all_structures();
+    }
+    for(const string& name : structure_names) {
+        structures.push_back(model.get_structure_ptr(name));
+    }
+    model.start_logistics(members, structures);
+    work_auto_command = "work-auto " + group_name;
+    for(const string& name : structure_names) {
+        work_auto_command += " " + name;
+    }
+}
+//Every script is opened, and every world cloned, before any variant
+//starts, so a bad file name leaves nothing running. Each variant is only
+//touched by its own thread until that thread has been joined.
+void Controller::fork()
+{
+    int ticks;
+    input >> ticks;
+    if(!input) {
+        throw Error{error_reading_int_c};
+    }
+    if(ticks < 0) {
+        throw Error{"Tick count must not be negative!"};
+    }
+    vector<string> scripts = read_rest_of_line(input);
+    if(scripts.empty()) {
+        throw Error{"Expected at least one script!"};
+    }
+    if(set<string>(scripts.begin(), scripts.end()).size() < scripts.size()) {
+        throw Error{"Each script can only be forked once!"};
+    }
+    vector<std::unique_ptr<Variant>> variants;
+    for(const string& script : scripts) {
+        std::unique_ptr<Variant> variant(new Variant);
+        variant->script = script;
+        variant->input.open(script);
+        if(!variant->input) {
+            throw Error{"Could not open input file!"};
+        }
+        variant->output.open(script + fork_output_suffix_c);
+        if(!variant->output) {
+            throw Error{"Could not open output file!"};
+        }
+        variant->output.copyfmt(output);
+        variant->world = model.clone(variant->output);
+        variants.push_back(std::move(variant));
+    }
+    vector<std::thread> threads;
+    for(auto& variant : variants) {
+        threads.push_back(std::thread(run_variant, std::ref(*variant), ticks));
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    for(auto& variant : variants) {
+        output << variant->script << ": time " << variant->world->get_time()
+            << ", " << variant->world->get_all_agents().size() << " agents, "
+            << variant->world->get_all_structures().size() << " structures";
+        if(!variant->error.empty()) {
+            output << ", stopped by: " << variant->error;
+        }
+        output << endl;
+    }
+}
+//A variant's Controller catches whatever its commands throw, so only a
+//failed update can stop it early
+void run_variant(Variant& variant, int ticks)
 {
-    cin.clear();
-    while(cin.get() != '\n');
+    try {
+        Controller controller(*variant.world, variant.input);
+        controller.run();
+        for(int i = 0; i < ticks; i++) {
+            variant.world->update();
+        }
+        variant.world->set_async_drawing(false);
+    }
+    catch(exception& error) {
+        variant.error = error.what();
+    }
+}
+//Reads and checks the whole order before any agent hears of it, then
+//gives it to every agent in one pass with their output muted
+void Controller::order_group()
+{
+    string group_name;
+    input >> group_name;
+    vector<shared_ptr<Agent>> members = get_group(group_name);
+    string order;
+    input >> order;
+    int obeying;
+    const char* doing;
+    if(order == group_move_c) {
+        Point destination = get_Point(input);
+        double spacing;
+        input >> spacing;
+        if(!input) {
+            throw Error{error_reading_double_c};
+        }
+        if(spacing < 0.) {
+            throw Error{"Spacing must not be negative!"};
+        }
+        obeying = move_group(members, destination, spacing);
+        doing = "moving";
+    } else if(order == group_work_c) {
+        vector<string> structure_names = read_rest_of_line(input);
+        if(structure_names.empty() || structure_names.size() % 2) {
+            throw Error{"Expected pairs of structures!"};
+        }
+        obeying = work_group(members, structure_names);
+        doing = "working";
+    } else if(order == group_attack_c) {
+        obeying = attack_group(members);
+        doing = "attacking";
+    } else if(order == group_stop_c) {
+        {
+            Output_muter muter(output);
+            for(shared_ptr<Agent> agent : members) {
+                agent->stop();
+            }
+        }
+        obeying = static_cast<int>(members.size());
+        doing = "stopped";
+    } else {
+        throw Error{"Unrecognized command!"};
+    }
+    output << group_name << ": " << obeying << " of " << members.size()
+        << " agents " << doing << endl;
+}
+
+//Agents keep the order they had from bottom to top and left to right, so
+//their paths to the formation mostly don't cross
+int Controller::move_group(vector<shared_ptr<Agent>>& members,
+                           Point destination, double spacing)
+{
+    sort(members.begin(), members.end(),
+         [](shared_ptr<Agent> a1, shared_ptr<Agent> a2) {
+        Point p1 = a1->get_location(), p2 = a2->get_location();
+        return p1.y < p2.y || (p1.y == p2.y && p1.x < p2.x);
+    });
+    int count = static_cast<int>(members.size());
+    int columns = grid_columns(count, 1., 1.);
+    int rows = (count + columns - 1) / columns;
+    Point corner{destination.x - (columns - 1) * spacing / 2.,
+                 destination.y - (rows - 1) * spacing / 2.};
+    Output_muter muter(output);
+    for(int i = 0; i < count; i++) {
+        members[i]->move_to(Point{corner.x + (i % columns) * spacing,
+                                  corner.y + (i / columns) * spacing});
+    }
+    return count;
+}
+//Every structure is looked up before anyone starts; agents that can't
+//work are skipped
+int Controller::work_group(vector<shared_ptr<Agent>>& members,
+                           const vector<string>& structure_names)
+{
+    vector<shared_ptr<Structure>> structures;
+    for(const string& name : structure_names) {
+        structures.push_back(model.get_structure_ptr(name));
+    }
+    int pairs = static_cast<int>(structures.size() / 2);
+    int working = 0;
+    Output_muter muter(output);
+    for(shared_ptr<Agent> agent : members) {
+        int pair = working % pairs;
+        try {
+            agent->start_working(structures[2 * pair],
+                                 structures[2 * pair + 1]);
+            working++;
+        }
+        catch(Error&) {
+            //this kind of agent doesn't work
+        }
+    }
+    return working;
+}
+//Agents that can't attack, or have no enemy in range, are skipped
+int Controller::attack_group(vector<shared_ptr<Agent>>& members)
+{
+    set<string> member_names;
+    for(shared_ptr<Agent> agent : members) {
+        member_names.insert(agent->get_name());
+    }
+    int attacking = 0;
+    Output_muter muter(output);
+    for(shared_ptr<Agent> agent : members) {
+        shared_ptr<Agent> enemy = find_nearest_agent(model, agent, member_names);
+        if(!enemy) {
+            continue;
+        }
+        try {
+            agent->start_attacking(enemy);
+            attacking++;
+        }
+        catch(Error&) {
+            //can't attack, or the enemy is out of range
+        }
+    }
+    return attacking;
+}
+//Members that have died or disappeared are dropped for good
+vector<shared_ptr<Agent>> Controller::get_group(const string& name)
+{
+    auto group_iter = groups.find(name);
+    if(group_iter == groups.end()) {
+        throw Error{"Group not found!"};
+    }
+    vector<weak_ptr<Agent>>& members = group_iter->second;
+    vector<shared_ptr<Agent>> living;
+    vector<weak_ptr<Agent>> still_members;
+    for(weak_ptr<Agent>& member : members) {
+        shared_ptr<Agent> agent = member.lock();
+        if(agent && agent->is_alive()) {
+            living.push_back(agent);
+            still_members.push_back(member);
+        }
+    }
+    members.swap(still_members);
+    if(living.empty()) {
+        throw Error{"Group has no living agents!"};
+    }
+    return living;
+}
+
+//Asks the location store, checking only the candidates nearer than the
+//best so far
+shared_ptr<Agent> find_nearest_agent(const Model& model,
+                                     shared_ptr<Agent> agent,
+                                     const set<string>& excluded)
+{
+    Location_store::Located_object nearest;
+    if(!model.get_location_store().find_nearest(agent->get_location(),
+                                                [&](const string& name) {
+        return !excluded.count(name) && model.is_agent_present(name) &&
+            model.get_agent_ptr(name)->is_alive();
+    }, nearest)) {
+        return nullptr;
+    }
+    return model.get_agent_ptr(nearest.first);
+}
+
+//Stops at the newline, so a bad word can still be skipped with the line
+vector<string> read_rest_of_line(std::istream& input)
+{
+    vector<string> words;
+    while(true) {
+        int next = input.peek();
+        if(next == '\n' || next == EOF) {
+            return words;
+        }
+        if(isspace(next)) {
+            input.get();
+            continue;
+        }
+        string word;
+        input >> word;
+        words.push_back(word);
+    }
+}
+
+//clears any bad state input has and reads characters until the next newline
+void skip_Input_Line(std::istream& input)
+{
+    input.clear();
+    while(input.get() != '\n' && input);
+}
+
+//Shared by the state trace and the hash trace
+int read_trace_interval(const string& every, std::istream& input)
+{
+    if(every != trace_every_c) {
+        throw Error{"Expected every!"};
+    }
+    int interval;
+    input >> interval;
+    if(!input) {
+        throw Error{error_reading_int_c};
+    }
+    if(interval <= 0) {
+        throw Error{"Trace interval must be positive!"};
+    }
+    return interval;
+}
+
+//A render thread might still be drawing the map, so it is stopped first
+//and restarted afterwards
+void release_map_terminal(Model& model, Map_view& view)
+{
+    bool async = model.is_drawing_async();
+    model.set_async_drawing(false);
+    view.release_terminal(model.get_output());
+    model.set_async_drawing(async);
+}
+
+//The snapshot sits beside the journal's segments
+string snapshot_name(const string& prefix)
+{
+    return prefix + snapshot_suffix_c;
+}
+
+//Segments are numbered from 1
+string segment_name(const string& prefix, int segment)
+{
+    return prefix + segment_suffix_c + to_string(segment);
+}
+
+//Opening the file is the only portable check
+bool file_exists(const string& filename)
+{
+    std::ifstream file(filename.c_str());
+    return file.good();
+}
+
+//Segments already gone are no error
+void remove_segments(const string& prefix, int first, int last)
+{
+    for(int segment = first; segment < last; segment++) {
+        std::remove(segment_name(prefix, segment).c_str());
+    }
 }
@@ -1,22 +1,60 @@
 /* Controller
 This class is responsible for controlling the Model and View according to interactions
 with the user.
+Each Controller drives one world, reading commands from its input and writing
+to the world's output. The user's Controller owns the initial world; the fork
+command clones it and runs a script against each clone on a thread of its
+own, under a Controller of its own.
+The user's Controller can also journal every command that changes the world,
+taking a snapshot of the world every so many ticks; after a crash, the world
+is recovered by reading the latest snapshot and replaying the commands
+journaled since, under a Controller of their own.
 */
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 #include <string>
+#include <vector>
+#include <map>
 #include <memory>
+#include <istream>//reading through the recorder
 class View;//incomplete declarations
 class Agent;
+class Model;
+class Input_recorder;
+struct Point;
 
 class Controller {
 public:
+    //creates the initial world, and reads commands from cin
+    Controller();
+    //drives the given world, reading commands from input_; the world
+    //must outlive the Controller
+    Controller(Model& model_, std::istream& input_);
+    //defined out of line, where Model is complete
+    ~Controller();
 
-	//run the program by acccepting user commands
+	//run the program by acccepting user commands until "quit" is read
+	//or the input runs out
 	void run();
 	
 private:
-    //opens a view of the given type, ie. map if "map", health if "health"
+    std::unique_ptr<Model> own_model;//the world, if this Controller made it
+    Model& model;
+    std::unique_ptr<Input_recorder> recorder;//keeps each command's text
+    std::istream input;//reads through recorder
+    std::ostream& output;//the world's output
+    //where commands are being journaled, or nullptr if they aren't;
+    //defined in Controller.cpp
+    struct Journaling;
+    std::unique_ptr<Journaling> journaling;
+    //the last work-auto command, while the plan it started may be running
+    std::string work_auto_command;
+    
+
+    //opens a view of the given type, ie. map if "map", health if "health",
+    //totals by type if "stats", crowding if "heatmap", the values each
+    //object has had if "history",
+    //or a telemetry stream to the file named next if "telemetry"
     void open();
     //has map_view's default settings set, if open
     void set_default_map();
@@ -29,15 +67,69 @@ private:
     
     //reads in two doubles and notifies map_view to change the origin
     void pan();
+    //reads "size", "zoom", "pan" or "default" and then what size, zoom
+    //and pan read for the map, and changes the heatmap view's settings
+    void adjust_heatmap();
+    //reads an object's name and has the history view show how its health
+    //and amount have changed; "full" after the name lists every sample
+    void show_history();
+    //reads a file name, a width and a height, and has Model write an
+    //image of the whole world to the file
+    void snapshot_image();
+    //reads "ansi" or "plain" and has map_view draw only its changes
+    //using terminal escape sequences, or draw itself in full as text
+    void set_terminal();
     //orders all views to draw themselves
     void draw();
-    //closes the view read in from stdin. If no view exists, throws error
+    //reads "async" or "sync" and has Model draw views on a render
+    //thread or on this one
+    void set_rendering();
+    //reads a number of microseconds, "off", or "stats", and sets or
+    //removes the Model's per-tick task budget, or has it describe its tasks;
+    //a budget can't be set while journaling
+    void set_budget();
+    //reads a view name and a number of ticks, and has the view redraw
+    //no more often than that; 0 redraws it every time
+    void set_refresh();
+    //reads a health or amounts view's name and either "lowest" or
+    //"highest" and a count, to show only that many objects in that order,
+    //or "all" to show every object again
+    void set_top();
+    //reads a health or amounts view's name and either "prefix" and a name
+    //prefix, or "type" and a type name, to show only matching objects,
+    //or "none" to show every object again
+    void set_filter();
+    //closes the view read in from the input. If no view exists, throws error
     void close();
     //forces every object in existence to describe itself by contacting
     //model
     void describe();
     //forces every object to update its current existence - go ahead 1 turn
     void update();
+    //reads a label and has Model mark the world's current state with it
+    void set_checkpoint();
+    //reads a label and has Model put the world back the way it was at the
+    //checkpoint with that label
+    void rewind();
+    //has Model output the hash of the world's current state
+    void show_hash();
+    //reads either "off", or a name, "every", and a tick interval, and
+    //stops journaling, or starts journaling commands to files with that
+    //name and taking a snapshot every interval ticks; files left there by
+    //an earlier journal are discarded. Refuses to start while there is a
+    //task budget.
+    void set_journal();
+    //reads a name, and puts the world back the way it was when the last
+    //command was journaled to files with that name. Work spread over ticks
+    //by a task budget depends on the clock, so a run with a budget can't be
+    //replayed exactly, and is never journaled.
+    void recover();
+    //reads either "off", or a file name, "every", and a tick interval,
+    //and has Model stop or start tracing accordingly
+    void set_trace();
+    //reads either "off", or "every" and a tick interval, and has Model stop
+    //or start outputting the state hash accordingly
+    void set_hash_trace();
     //reads in a name, type and location for the new structure,
     //and passes it to model, verifying input in the process.
     //If input is incorrect, throws an Error.
@@ -48,8 +140,15 @@ private:
     //If input is incorrect, throws an Error.
     void train();
     
+    //Reads a type, name prefix, count, and the corners of a rectangle, and
+    //adds that many structures or agents of the type, spread over the
+    //rectangle on a grid. If input is incorrect or any of the generated
+    //names is taken, throws an Error and adds nothing.
+    void build_many();
+    void train_many();
+    
     //Calls the necessary functions ot have an agent move
-    //to an x,y position read in from stdin.
+    //to an x,y position read in from the input.
     void move(std::shared_ptr<Agent> agent);
     
     //Reads in two structure names and orders the specified
@@ -64,6 +163,68 @@ private:
     //Orders the agent to stop.
     void stop(std::shared_ptr<Agent> agent);
     
+    //Reads a group name and how to pick its agents: "names" followed by
+    //agent names, "type" and an agent type, or "region" and two corners.
+    //Replaces any group of that name. Throws an Error if no living agents
+    //are picked or the input is incorrect.
+    void define_group();
+    //Reads a group name and forgets the group
+    void disband_group();
+    //Reads either "off", or a group name followed by any number of
+    //structure names, and has Model plan work for the group's Peasants
+    //between those structures, or all of them if none are named
+    void work_auto();
+    //Reads a number of ticks and the names of script files. Runs each
+    //script, followed by that many updates, against its own copy of the
+    //world, all at once on separate threads; the copies' output goes to
+    //files named after the scripts with ".out" added. Waits for them all,
+    //then outputs how each ended up. This world is left untouched.
+    //Throws an Error if the input is incorrect or a file can't be opened.
+    void fork();
+    //Reads a group name and an order for all of its agents:
+    //"move" to a point in a square formation with the given spacing,
+    //"work" between the pairs of structures listed, "attack" the nearest
+    //agent outside the group, or "stop". The agents' own messages are
+    //replaced by a one-line summary.
+    void order_group();
+    
+    //Has each agent move to its place in a square formation centered on
+    //destination; returns the number of agents now moving
+    int move_group(std::vector<std::shared_ptr<Agent>>& members,
+                   Point destination, double spacing);
+    //Has the agents take turns at the pairs of structures; returns the
+    //number of agents now working
+    int work_group(std::vector<std::shared_ptr<Agent>>& members,
+                   const std::vector<std::string>& structure_names);
+    //Has each agent attack the agent nearest it that is not in the group;
+    //returns the number of agents now attacking
+    int attack_group(std::vector<std::shared_ptr<Agent>>& members);
+    
+    //Journals the command just run, then takes a snapshot if one is due
+    void journal_command();
+    //Starts a new journal segment and has Model write a snapshot to go
+    //with it, waiting for it to be written if wait is true; if a snapshot
+    //is still being written, waits for it first if wait is true, and
+    //otherwise does nothing
+    void take_snapshot(bool wait);
+    //Once the latest snapshot has been written, deletes the segments that
+    //came before it
+    void remove_old_segments();
+    //Journals a command recreating each group and any automatic work, since
+    //snapshots only hold the world
+    void journal_controller_state();
+    //Commits the journal and waits for any snapshot, then stops journaling
+    void stop_journal();
+    //Replays the commands in the named journal segment, with their output
+    //muted; returns how many there were
+    int replay_segment(const std::string& filename);
+    
+    //Returns the living members of the group, dropping any that are gone.
+    //Throws an Error if there is no such group.
+    std::vector<std::shared_ptr<Agent>> get_group(const std::string& name);
+    
+    std::map<std::string, std::vector<std::weak_ptr<Agent>>> groups;
+    
     struct New_object {
         std::string name;
         std::string type;
@@ -74,6 +235,19 @@ private:
     //Returns a struct with the data it read
     New_object create_object();
     
+    struct New_objects {
+        std::string type;
+        std::vector<std::string> names;
+        std::vector<Point> locations;
+    };
+    //Reads in a type, name prefix, count and rectangle, and generates
+    //a unique name and a location for each new object.
+    //Returns a struct with the data it generated
+    New_objects create_objects();
+    
+	// disallow copy/move construction or assignment
+	Controller(const Controller&) = delete;
+	Controller& operator= (const Controller&)  = delete;
 };
 
 #endif
@@ -1,12 +1,14 @@
 #include "Farm.h"
 #include "Model.h"
-#include <iostream>//cout, endl
+#include "State_hash.h"
+#include "Binary_writer.h"
+#include "Binary_reader.h"
+#include <ostream>//endl
 
 const double default_starting_food_c = 50.0;
 const double default_production_c = 2.0;
 
 using std::string;
-using std::cout;
 using std::endl;
 
 //constructs Farm by invoking Structure constructor
@@ -18,6 +20,7 @@ Structure(name_, location_), cur_amount(default_starting_food_c)
 //we can
 double Farm::withdraw(double amount_to_get)
 {
+    will_change();
     if(amount_to_get > cur_amount) {
         amount_to_get = cur_amount;
         cur_amount = 0;//we've emptied out all we can
@@ -32,21 +35,43 @@ double Farm::withdraw(double amount_to_get)
 //adds the production amount to our current stored amount
 void Farm::update()
 {
+    will_change();
     cur_amount += default_production_c;
     broadcast_current_state();//let Model know of changes to food
-    cout << "Farm " << get_name() << " now has " << cur_amount << endl;
+    get_output() << "Farm " << get_name() << " now has " << cur_amount << endl;
+}
+//All Farms produce at the same rate
+double Farm::get_production_rate() const
+{
+    return default_production_c;
 }
 //Simply announces it's a farm, calls the structure describe,
 //and outputs the current amount of food available.
 void Farm::describe() const
 {
-    cout << "Farm ";
+    get_output() << "Farm ";
     Structure::describe();
-    cout << "   Food available: " << cur_amount << endl;
+    get_output() << "   Food available: " << cur_amount << endl;
+}
+//The production rate is the same for every Farm
+void Farm::hash_state(State_hash& hash) const
+{
+    Structure::hash_state(hash);
+    hash.add(cur_amount);
+}
+//Only the food on hand can change
+void Farm::write_state(Binary_writer& writer) const
+{
+    writer.put(cur_amount);
+}
+//Read back just as written
+void Farm::read_state(Binary_reader& reader)
+{
+    cur_amount = reader.get<double>();
 }
 //Broadcasts additional information about the current amount stored
 void Farm::broadcast_current_state()
 {
     Structure::broadcast_current_state();
-    Model::get_instance().notify_amount(get_name(), cur_amount);
+    get_model().notify_amount(get_name(), cur_amount);
 }
@@ -10,8 +10,16 @@ Food can be withdrawn, but no provision is made for depositing any.
 
 class Farm : public Structure {
 public:
+    //the name this type is created by
+    static constexpr const char* type_name() {return "Farm";}
+    const char* get_type_name() const override {return type_name();}
+
     //constructs a Farm from the given name and location
 	Farm (const std::string& name_, Point location_);
+    std::shared_ptr<Structure> clone() const override
+        {return std::make_shared<Farm>(*this);}
+    void restore(const Sim_object& saved) override
+        {*this = static_cast<const Farm&>(saved);}
 		
 	// returns the specified amount, or the remaining amount, whichever is less,
 	// and deducts that amount from the amount on hand
@@ -22,6 +30,15 @@ public:
 
 	// output information about the current state
 	void describe() const override;
+	// mixes in the food on hand
+	void hash_state(State_hash& hash) const override;
+	// writes or reads back the food on hand, for a snapshot
+	void write_state(Binary_writer& writer) const override;
+	void read_state(Binary_reader& reader) override;
+    //returns the amount of food on hand
+    double get_amount() const {return cur_amount;}
+    //returns the amount of food added on each update
+    double get_production_rate() const;
 	//notify Model about food as well as other structure information
     void broadcast_current_state() override;
 private:
@@ -0,0 +1,236 @@
+#include "Flow_field.h"
+#include <limits>//numeric_limits
+#include <cmath>//floor, ceil, sqrt
+#include <algorithm>//sort, unique
+
+using std::vector;
+
+const int unreached_c = std::numeric_limits<int>::max();
+//costs of a step to a neighbor; a diagonal costs about root 2 times more
+const int straight_cost_c = 5;
+const int diagonal_cost_c = 7;
+//column and row offsets of the eight neighbors of a cell
+const int neighbor_columns_c[] = {1, -1, 0, 0, 1, 1, -1, -1};
+const int neighbor_rows_c[] = {0, 0, 1, -1, 1, -1, 1, -1};
+const int num_neighbors_c = 8;
+const signed char go_straight_c = -1;
+//what is known about a cell's line of sight to the destination
+const signed char sight_unknown_c = 0;
+const signed char sight_clear_c = 1;
+const signed char sight_blocked_c = 2;
+//how far apart, in cells, a line of sight is sampled
+const double sight_step_c = 0.25;
+
+//returns the unit vector from location straight to destination
+Cartesian_vector straight_to(Point location, Point destination);
+
+//returns true if no blocked cell, other than its own, lies on the line
+//from the middle of the cell at column, row to the middle of the grid
+bool sees_center(int column, int row, int radius,
+                 const vector<char>& blocked);
+
+//Only the blocked cells are found; nothing else is worked out until some
+//object's way is blocked
+Flow_field::Flow_field(Point destination_, double cell_size_, int radius_,
+                       const vector<Point>& obstacles) :
+destination(destination_), cell_size(cell_size_), radius(radius_),
+width(2 * radius_ + 1), stale(false)
+{
+    int goal = radius * width + radius;
+    for(Point obstacle : obstacles) {
+        int index;
+        if(get_cell(obstacle, index) && index != goal) {
+            blocked_cells.push_back(index);
+        }
+    }
+    std::sort(blocked_cells.begin(), blocked_cells.end());
+    blocked_cells.erase(std::unique(blocked_cells.begin(),
+                                    blocked_cells.end()),
+                        blocked_cells.end());
+}
+
+//Outside the grid, nothing is in the way. Each cell's line is only looked
+//along the first time an object is in it.
+bool Flow_field::is_straight(Point location) const
+{
+    int index;
+    if(is_clear() || !get_cell(location, index)) {
+        return true;
+    }
+    if(sights.empty()) {
+        blocked.assign(width * width, 0);
+        for(int blocked_index : blocked_cells) {
+            blocked[blocked_index] = 1;
+        }
+        sights.assign(width * width, sight_unknown_c);
+    }
+    if(sights[index] == sight_unknown_c) {
+        sights[index] = sees_center(index % width, index / width, radius,
+                                    blocked) ?
+            sight_clear_c : sight_blocked_c;
+    }
+    return sights[index] == sight_clear_c;
+}
+
+//A cell left to go straight has nothing better than a straight line
+Cartesian_vector Flow_field::get_direction(Point location) const
+{
+    if(is_straight(location)) {
+        return straight_to(location, destination);
+    }
+    if(next_neighbors.empty()) {
+        build();
+    }
+    int index;
+    get_cell(location, index);
+    if(next_neighbors[index] == go_straight_c) {
+        return straight_to(location, destination);
+    }
+    int n = next_neighbors[index];
+    Cartesian_vector direction(neighbor_columns_c[n], neighbor_rows_c[n]);
+    return direction / sqrt(direction.delta_x * direction.delta_x +
+                            direction.delta_y * direction.delta_y);
+}
+
+//Each half-cell step samples the field again
+Point Flow_field::advance(Point location, double distance) const
+{
+    double max_step = is_clear() ? distance : cell_size / 2.;
+    while(distance > 0.) {
+        double step = distance < max_step ? distance : max_step;
+        if(cartesian_distance(location, destination) <= step) {
+            return destination;
+        }
+        location = location + get_direction(location) * step;
+        distance -= step;
+    }
+    return location;
+}
+
+//Dijkstra's algorithm out from the destination's cell over the unblocked
+//cells, moving diagonally only where neither side is blocked. Step costs
+//are small whole numbers, so the cells waiting to be visited are kept in a
+//ring of buckets, one per cost, instead of a heap. Each cell then heads for
+//its cheapest neighbor, so an object inside a blocked cell can still step
+//out of it; cells next to the destination's, and cells that can't reach
+//it, are left to go straight.
+void Flow_field::build() const
+{
+    int num_cells = width * width;
+    int goal = radius * width + radius;
+    //can we step from the cell at column, row by neighbor n?
+    auto can_step = [&](int column, int row, int n) {
+        int to_column = column + neighbor_columns_c[n];
+        int to_row = row + neighbor_rows_c[n];
+        if(to_column < 0 || to_column >= width ||
+           to_row < 0 || to_row >= width ||
+           blocked[to_row * width + to_column]) {
+            return false;
+        }
+        return (neighbor_columns_c[n] == 0 || neighbor_rows_c[n] == 0) ||
+            (!blocked[row * width + to_column] &&
+             !blocked[to_row * width + column]);
+    };
+    vector<int> costs(num_cells, unreached_c);
+    vector<vector<int>> buckets(diagonal_cost_c + 1);
+    costs[goal] = 0;
+    buckets[0].push_back(goal);
+    int num_waiting = 1;
+    for(int cost = 0; num_waiting > 0; cost++) {
+        vector<int>& bucket = buckets[cost % buckets.size()];
+        for(int index : bucket) {
+            if(costs[index] != cost) {
+                continue;//already reached more cheaply
+            }
+            int column = index % width, row = index / width;
+            for(int n = 0; n < num_neighbors_c; n++) {
+                if(!can_step(column, row, n)) {
+                    continue;
+                }
+                int next = (row + neighbor_rows_c[n]) * width +
+                    column + neighbor_columns_c[n];
+                int next_cost = cost +
+                    ((neighbor_columns_c[n] && neighbor_rows_c[n]) ?
+                     diagonal_cost_c : straight_cost_c);
+                if(next_cost < costs[next]) {
+                    costs[next] = next_cost;
+                    buckets[next_cost % buckets.size()].push_back(next);
+                    num_waiting++;
+                }
+            }
+        }
+        num_waiting -= static_cast<int>(bucket.size());
+        bucket.clear();
+    }
+    next_neighbors.assign(num_cells, go_straight_c);
+    for(int index = 0; index < num_cells; index++) {
+        if(index == goal) {
+            continue;
+        }
+        int column = index % width, row = index / width;
+        int best = -1, best_next = -1;
+        for(int n = 0; n < num_neighbors_c; n++) {
+            if(!can_step(column, row, n)) {
+                continue;
+            }
+            int next = (row + neighbor_rows_c[n]) * width +
+                column + neighbor_columns_c[n];
+            if(costs[next] == unreached_c) {
+                continue;
+            }
+            if(best < 0 || costs[next] < costs[best_next]) {
+                best = n;
+                best_next = next;
+            }
+        }
+        if(best >= 0 && best_next != goal) {
+            next_neighbors[index] = static_cast<signed char>(best);
+        }
+    }
+}
+
+//Cells are centered on the destination's cell
+bool Flow_field::get_cell(Point location, int& index) const
+{
+    double column =
+        floor((location.x - destination.x) / cell_size + 0.5) + radius;
+    double row =
+        floor((location.y - destination.y) / cell_size + 0.5) + radius;
+    if(column < 0. || column >= width || row < 0. || row >= width) {
+        return false;
+    }
+    index = static_cast<int>(row) * width + static_cast<int>(column);
+    return true;
+}
+
+//The zero vector if already there
+Cartesian_vector straight_to(Point location, Point destination)
+{
+    double distance = cartesian_distance(location, destination);
+    if(distance == 0.) {
+        return Cartesian_vector();
+    }
+    return (destination - location) / distance;
+}
+
+//Works in cells measured from the middle of the grid, and samples the line
+//closely enough that only a corner of a blocked cell could be missed
+bool sees_center(int column, int row, int radius,
+                 const vector<char>& blocked)
+{
+    int width = 2 * radius + 1;
+    double x = column - radius, y = row - radius;
+    int num_steps = static_cast<int>(ceil(sqrt(x * x + y * y) /
+                                          sight_step_c));
+    for(int step = 1; step < num_steps; step++) {
+        double remaining = 1. - static_cast<double>(step) / num_steps;
+        int sample_column =
+            static_cast<int>(floor(x * remaining + 0.5)) + radius;
+        int sample_row = static_cast<int>(floor(y * remaining + 0.5)) + radius;
+        if((sample_column != column || sample_row != row) &&
+           blocked[sample_row * width + sample_column]) {
+            return false;
+        }
+    }
+    return true;
+}
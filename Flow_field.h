@@ -0,0 +1,89 @@
+/*
+A Flow_field gives the direction to move in, from anywhere, to reach one
+destination, so that every object headed to the same place can share the
+work of finding the way. Model keeps one field per destination and hands it
+to each Moving_object that starts moving there.
+
+The field covers a square grid around the destination, and any cell holding
+an obstacle, such as a structure other than the destination, is blocked.
+When no cell is blocked at all, every object just goes straight. Otherwise,
+the first time an object is in a cell, the field looks along the straight
+line from that cell to the destination, and remembers whether any blocked
+cell is in the way; an object in a clear cell goes straight. The first time
+one is in a cell whose line is blocked, the field works out the cost of
+reaching the destination from every cell, going around blocked cells, and
+points each cell at its cheapest neighbor. After that, sampling a cell
+already visited is a single array lookup, however many objects use the
+field and however many cells are blocked. Outside the grid, the direction
+is simply straight at the destination.
+
+Fields go stale when the world changes in a way that could move the
+obstacles, such as a structure being built; objects using a stale field ask
+Model for a fresh one.
+*/
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "Geometry.h"
+#include <vector>
+
+class Flow_field {
+public:
+    //Creates a field leading to destination over a grid of cells cell_size
+    //across, reaching radius cells out from the destination in each
+    //direction. Each cell holding one of the obstacles is blocked, except
+    //the destination's own.
+    Flow_field(Point destination_, double cell_size_, int radius_,
+               const std::vector<Point>& obstacles);
+
+    Point get_destination() const {return destination;}
+
+    //returns true if nothing can block the way, so every object can go
+    //straight to the destination
+    bool is_clear() const {return blocked_cells.empty();}
+
+    //returns true if no blocked cell, other than the one location is in,
+    //lies on the straight line from the middle of that cell to the
+    //destination
+    bool is_straight(Point location) const;
+
+    //Returns the unit vector to move along from location
+    Cartesian_vector get_direction(Point location) const;
+
+    //Returns where following the field for distance from location leads,
+    //stepping no more than half a cell at a time so that nothing thinner
+    //than a cell is skipped over; stops early at the destination
+    Point advance(Point location, double distance) const;
+
+    //marks the field as out of date
+    void mark_stale() {stale = true;}
+    //returns true if the field may no longer match the world
+    bool is_stale() const {return stale;}
+
+private:
+    Point destination;
+    double cell_size;
+    int radius;
+    int width;//cells along each side of the grid
+    bool stale;
+    //the blocked cells, in increasing order
+    std::vector<int> blocked_cells;
+    //a flag for each cell, row by row, set if the cell is blocked;
+    //empty until first needed
+    mutable std::vector<char> blocked;
+    //whether each cell's straight line to the destination is clear,
+    //blocked, or not yet looked at; empty until first needed
+    mutable std::vector<signed char> sights;
+    //which neighbor to head for out of each cell, row by row, or
+    //-1 to go straight at the destination; empty until first needed
+    mutable std::vector<signed char> next_neighbors;
+
+    //works out the cost to the destination from every cell, then the
+    //neighbor to head for out of each
+    void build() const;
+    //sets index to the cell holding location and returns true,
+    //or returns false if location is outside the grid
+    bool get_cell(Point location, int& index) const;
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include "Heatmap_view.h"
+#include "Utility.h"
+#include <cmath>//floor, ldexp, lround
+#include <ostream>
+#include <algorithm>//min, max
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::endl;
+using std::shared_ptr;
+using std::make_shared;
+using std::floor;
+using std::ldexp;
+
+const double finest_cell_size_c = 0.5;
+const int num_levels_c = 20;
+//a tile with no objects, then one glyph for each doubling of the count:
+//1, 2-3, 4-7, and so on, with the last one for anything more
+const char* const density_glyphs_c[] = {". ", ": ", "- ", "= ", "+ ", "* ",
+                                        "# ", "% ", "@ "};
+const int num_density_glyphs_c = 9;
+const char* const density_legend_c =
+    ". 0, : 1, - 2-3, = 4-7, + 8-15, * 16-31, # 32-63, % 64-127, @ 128+";
+
+//Heatmap_frame adds the map parameters and a legend for the glyphs to
+//the grid of a Tile_frame
+class Heatmap_frame : public Tile_frame {
+public:
+    Heatmap_frame(int size_, double scale_, Point origin_, Tile_grid map_) :
+    Tile_frame(size_, scale_, origin_, std::move(map_))
+    {}
+    //Outputs the parameters and the legend, then the map
+    void render(ostream& os) const override;
+};
+
+//How much of a cell falls in one row or column of tiles
+struct Tile_share {
+    int index;
+    double fraction;
+};
+
+//Sets shares to the rows or columns of tiles that the span of a cell
+//starting at cell_start overlaps, along one axis of a map whose tiles
+//start at map_start, and the fraction of the span in each.
+void get_tile_shares(double cell_start, double cell_size, double map_start,
+                     double scale, int size, vector<Tile_share>& shares);
+
+//Returns the glyph for a tile with about the given number of objects in
+//it; any objects at all count as at least one
+const char* get_density_glyph(double count);
+
+//Returns the number of a cell's level-l ancestor's coordinate, rounding
+//down, so negative coordinates nest the same way positive ones do
+long long get_ancestor_coord(long long coord, int level);
+
+//Every level starts out empty
+Heatmap_view::Heatmap_view(const Model& model_) :
+Tile_view(model_), counts(num_levels_c)
+{
+}
+
+//The object's cells only change up to the first level where the old and
+//new locations share a cell, since the cells above that are shared too.
+void Heatmap_view::update_location(const string& name, Point location)
+{
+    auto loc_iter = locations.find(name);
+    if(loc_iter == locations.end()) {
+        locations.insert(std::make_pair(name, location));
+        add_to_cells(location, 1, num_levels_c);
+        mark_dirty();
+        return;
+    }
+    long long old_x, old_y, new_x, new_y;
+    get_grid_coords(loc_iter->second, finest_cell_size_c, old_x, old_y);
+    get_grid_coords(location, finest_cell_size_c, new_x, new_y);
+    int shared_level = 0;
+    while(shared_level < num_levels_c &&
+          (get_ancestor_coord(old_x, shared_level) !=
+               get_ancestor_coord(new_x, shared_level) ||
+           get_ancestor_coord(old_y, shared_level) !=
+               get_ancestor_coord(new_y, shared_level))) {
+        shared_level++;
+    }
+    if(shared_level > 0) {
+        add_to_cells(loc_iter->second, -1, shared_level);
+        add_to_cells(location, 1, shared_level);
+        mark_dirty();
+    }
+    loc_iter->second = location;
+}
+
+//No error if the object was never counted
+void Heatmap_view::update_remove(const string& name)
+{
+    auto loc_iter = locations.find(name);
+    if(loc_iter == locations.end()) {
+        return;
+    }
+    add_to_cells(loc_iter->second, -1, num_levels_c);
+    locations.erase(loc_iter);
+    mark_dirty();
+}
+
+//Adds up the counts of the cells in view at the chosen level, sharing each
+//cell's count among the tiles it overlaps by how much of it each covers,
+//so cells and tiles that don't line up don't make stripes. Cells are no
+//wider than a tile and at least half as wide, unless the map is zoomed in
+//past the finest level, so there are at most about four times as many
+//cells as tiles.
+shared_ptr<const View_frame> Heatmap_view::capture()
+{
+    int level = choose_level();
+    double cell_size = ldexp(finest_cell_size_c, level);
+    const auto& level_counts = counts[level];
+    int size = get_size();
+    double scale = get_scale();
+    Point origin = get_origin();
+    vector<vector<double>> tile_counts(size, vector<double>(size, 0.));
+    Region window = get_window();
+    long long lo_x, lo_y, hi_x, hi_y;
+    get_grid_coords(window.lower_left, cell_size, lo_x, lo_y);
+    get_grid_coords(window.upper_right, cell_size, hi_x, hi_y);
+    vector<Tile_share> x_shares, y_shares;
+    for(long long cx = lo_x; cx <= hi_x; cx++) {
+        get_tile_shares(cx * cell_size, cell_size, origin.x, scale, size,
+                        x_shares);
+        for(long long cy = lo_y; cy <= hi_y; cy++) {
+            auto count_iter = level_counts.find(make_grid_key(cx, cy));
+            if(count_iter == level_counts.end()) {
+                continue;
+            }
+            get_tile_shares(cy * cell_size, cell_size, origin.y, scale, size,
+                            y_shares);
+            for(const Tile_share& y_share : y_shares) {
+                for(const Tile_share& x_share : x_shares) {
+                    tile_counts[y_share.index][x_share.index] +=
+                        count_iter->second * x_share.fraction *
+                        y_share.fraction;
+                }
+            }
+        }
+    }
+    Tile_grid map(size, vector<string>(size));
+    for(int iy = 0; iy < size; iy++) {
+        for(int ix = 0; ix < size; ix++) {
+            map[iy][ix] = get_density_glyph(tile_counts[iy][ix]);
+        }
+    }
+    return make_shared<Heatmap_frame>(size, scale, origin, std::move(map));
+}
+
+//Empties every level
+void Heatmap_view::clear()
+{
+    counts.assign(num_levels_c, std::unordered_map<Grid_key, int>());
+    locations.clear();
+    mark_dirty();
+}
+
+//restores parameters to the default values
+void Heatmap_view::set_defaults()
+{
+    set_size(default_size_c);
+    set_scale(default_scale_c);
+    set_origin(Point{default_origin_x_c, default_origin_y_c});
+}
+
+//Returns a string representation of this view
+string Heatmap_view::get_name()
+{
+    return heatmap_view_name_c;
+}
+
+//Each level's cell is found from the finest one's coordinates, so the
+//levels always nest exactly. Cells left empty are dropped.
+void Heatmap_view::add_to_cells(Point location, int delta, int stop_level)
+{
+    long long cx, cy;
+    get_grid_coords(location, finest_cell_size_c, cx, cy);
+    for(int level = 0; level < stop_level; level++) {
+        auto& level_counts = counts[level];
+        Grid_key key = make_grid_key(get_ancestor_coord(cx, level),
+                                     get_ancestor_coord(cy, level));
+        int& count = level_counts[key];
+        count += delta;
+        if(count == 0) {
+            level_counts.erase(key);
+        }
+    }
+}
+
+//Each level's cells are twice as wide as the level below
+int Heatmap_view::choose_level() const
+{
+    int level = 0;
+    while(level + 1 < num_levels_c &&
+          ldexp(finest_cell_size_c, level + 1) <= get_scale()) {
+        level++;
+    }
+    return level;
+}
+
+//Outputs the parameters and what the glyphs mean, then the map itself
+void Heatmap_frame::render(ostream& os) const
+{
+    os << "Heatmap size: " << size << ", scale: " << scale << ", origin: "
+       << origin << endl;
+    os << "Objects per tile: " << density_legend_c << endl;
+    Tile_frame::render(os);
+}
+
+//Steps through the tiles from the one the span starts in to the one it
+//ends in, skipping any outside the map
+void get_tile_shares(double cell_start, double cell_size, double map_start,
+                     double scale, int size, vector<Tile_share>& shares)
+{
+    shares.clear();
+    double start = (cell_start - map_start) / scale;
+    double end = start + cell_size / scale;
+    for(int index = int(floor(start)); index < end; index++) {
+        if(index < 0 || index >= size) {
+            continue;
+        }
+        double overlap = std::min(end, index + 1.) - std::max(start,
+                                                              double(index));
+        shares.push_back(Tile_share{index, overlap / (end - start)});
+    }
+}
+
+//The glyph's index is the number of binary digits in the rounded count
+const char* get_density_glyph(double approx_count)
+{
+    long count = std::lround(approx_count);
+    if(count == 0 && approx_count > 0.) {
+        count = 1;
+    }
+    int index = 0;
+    while(count > 0 && index < num_density_glyphs_c - 1) {
+        count >>= 1;
+        index++;
+    }
+    return density_glyphs_c[index];
+}
+
+//Divides by 2 to the level, rounding toward negative infinity
+long long get_ancestor_coord(long long coord, int level)
+{
+    long long width = 1LL << level;
+    return coord >= 0 ? coord / width : -((-coord + width - 1) / width);
+}
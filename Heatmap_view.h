@@ -0,0 +1,59 @@
+/*
+Heatmap_view draws how crowded each part of the world is, rather than which
+objects are where. It counts the objects in square grid cells at several
+resolutions at once, each level's cells twice as wide as the level below,
+and keeps the counts up to date as objects move and disappear. To draw, it
+picks the level whose cells are about as big as a tile and adds up only the
+cells in view, so drawing takes the same time however many objects there are.
+*/
+#ifndef HEATMAP_VIEW_H
+#define HEATMAP_VIEW_H
+
+#include "Views.h"//Tile_view
+#include "Spatial_grid.h"//grid cells
+#include <string>
+#include <vector>//levels
+#include <unordered_map>//counts in cells, objects' locations
+#include <memory>
+
+class Heatmap_view : public Tile_view {
+public:
+    //Starts with the map's default size, scale and origin
+    Heatmap_view(const Model& model_);
+    
+    //Only wants to hear about objects moving and disappearing
+    int get_interests() const override
+        {return LOCATION_INTEREST | GONE_INTEREST;}
+    
+    //Moves the object from its old cells to its new ones
+    void update_location(const std::string& name, Point location) override;
+    //Takes the object out of its cells
+    void update_remove(const std::string& name) override;
+    
+    //Captures a density glyph for each tile, with a legend
+    std::shared_ptr<const View_frame> capture() override;
+    
+    //Forgets every object
+    void clear() override;
+    
+    // set the parameters to the default values
+    void set_defaults();
+    
+    //Returns the internal representation of the view's name
+    std::string get_name() override;
+
+private:
+    //counts[level] maps each non-empty cell of that level to the number of
+    //objects in it
+    std::vector<std::unordered_map<Grid_key, int>> counts;
+    std::unordered_map<std::string, Point> locations;
+    
+    //Adds delta to the count of each cell containing the location, from
+    //the finest level up to, but not including, stop_level
+    void add_to_cells(Point location, int delta, int stop_level);
+    //Returns the level whose cells are the widest no wider than a tile,
+    //or the finest level if even its cells are too wide
+    int choose_level() const;
+};
+
+#endif
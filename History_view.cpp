@@ -0,0 +1,186 @@
+#include "History_view.h"
+#include "Model.h"
+#include "Utility.h"
+#include <ostream>
+#include <algorithm>//min_element, max_element
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::endl;
+
+const int history_ring_size_c = 32;
+const int history_num_tiers_c = 3;
+const int history_merge_count_c = 4;
+//from the lowest value in a history to the highest
+const char* const sparkline_glyphs_c = "_.:-=+*#";
+const int num_sparkline_glyphs_c = 8;
+
+//Nothing has been recorded yet
+History_view::History_view(const Model& model_) : model(model_)
+{
+}
+
+//Records the health under the current time
+void History_view::update_health(const string& name, double health)
+{
+    histories[name].health.add(model.get_time(), health);
+}
+
+//Records the amount under the current time
+void History_view::update_amount(const string& name, double amount)
+{
+    histories[name].amount.add(model.get_time(), amount);
+}
+
+//No error if there is no history for the object
+void History_view::update_remove(const string& name)
+{
+    histories.erase(name);
+}
+
+//Drops every history
+void History_view::clear()
+{
+    histories.clear();
+}
+
+//Writes the health line, then the amount line
+void History_view::describe(const string& name, bool full, ostream& os) const
+{
+    auto history_iter = histories.find(name);
+    if(history_iter == histories.end()) {
+        throw Error{"No history for that object!"};
+    }
+    os << "History of " << name << ":" << endl;
+    describe_series("Health", history_iter->second.health, full, os);
+    describe_series("Amount", history_iter->second.amount, full, os);
+}
+
+//Returns a string representation of this view
+string History_view::get_name()
+{
+    return history_view_name_c;
+}
+
+//The sparkline has a glyph per sample, scaled between the lowest and
+//highest values. Coarse samples cover more ticks, so it is not to scale.
+void History_view::describe_series(const string& label, const Series& series,
+                                   bool full, ostream& os)
+{
+    if(series.empty()) return;
+    vector<Sample> samples = series.get_samples();
+    auto by_value = [](const Sample& s1, const Sample& s2) {
+        return s1.value < s2.value;
+    };
+    double lowest = std::min_element(samples.begin(), samples.end(),
+                                     by_value)->value;
+    double highest = std::max_element(samples.begin(), samples.end(),
+                                      by_value)->value;
+    string sparkline;
+    for(const Sample& sample : samples) {
+        int glyph = 0;
+        if(highest > lowest) {
+            glyph = static_cast<int>((sample.value - lowest) /
+                                     (highest - lowest) *
+                                     (num_sparkline_glyphs_c - 1) + 0.5);
+        }
+        sparkline += sparkline_glyphs_c[glyph];
+    }
+    os << label << " since time " << samples.front().tick << ": "
+       << sparkline << " (lowest " << lowest << ", highest " << highest
+       << ", now " << samples.back().value << ")" << endl;
+    if(!full) return;
+    for(const Sample& sample : samples) {
+        os << "   time " << sample.tick << ": " << sample.value << endl;
+    }
+}
+
+//Full when it holds as many samples as it ever can
+bool History_view::Sample_ring::full() const
+{
+    return count == history_ring_size_c;
+}
+
+//Counts around the ring from the oldest sample
+const History_view::Sample&
+History_view::Sample_ring::operator[](int index) const
+{
+    return samples[(oldest + index) % samples.size()];
+}
+
+//The newest sample is count - 1 places around from the oldest
+History_view::Sample& History_view::Sample_ring::newest()
+{
+    return samples[(oldest + count - 1) % samples.size()];
+}
+
+//Samples are only ever dropped from a full ring, so until storage has
+//grown to its final size, the oldest sample is at the front and the new
+//one can simply be appended
+void History_view::Sample_ring::push(Sample sample)
+{
+    if(samples.size() < static_cast<std::size_t>(history_ring_size_c)) {
+        samples.push_back(sample);
+    } else {
+        samples[(oldest + count) % history_ring_size_c] = sample;
+    }
+    count++;
+}
+
+//The dropped samples' slots are reused by the next pushes
+void History_view::Sample_ring::drop_oldest(int dropped)
+{
+    oldest = (oldest + dropped) % history_ring_size_c;
+    count -= dropped;
+}
+
+//Every tier starts out empty
+History_view::Series::Series() : tiers(history_num_tiers_c)
+{
+}
+
+//A value reported more than once in a tick only counts the last time
+void History_view::Series::add(int tick, double value)
+{
+    Sample_ring& recent = tiers.front();
+    if(!recent.empty() && recent.newest().tick == tick) {
+        recent.newest().value = value;
+        return;
+    }
+    push(0, Sample{tick, value});
+}
+
+//The oldest samples are in the last tier
+vector<History_view::Sample> History_view::Series::get_samples() const
+{
+    vector<Sample> result;
+    for(auto tier_iter = tiers.rbegin(); tier_iter != tiers.rend();
+        ++tier_iter) {
+        for(int index = 0; index < tier_iter->size(); index++) {
+            result.push_back((*tier_iter)[index]);
+        }
+    }
+    return result;
+}
+
+//The averaged sample takes the tick of the oldest of the samples it
+//replaces
+void History_view::Series::push(int tier, Sample sample)
+{
+    Sample_ring& ring = tiers[tier];
+    if(ring.full()) {
+        if(tier + 1 < history_num_tiers_c) {
+            double total = 0.;
+            for(int index = 0; index < history_merge_count_c; index++) {
+                total += ring[index].value;
+            }
+            push(tier + 1, Sample{ring[0].tick,
+                                  total / history_merge_count_c});
+            ring.drop_oldest(history_merge_count_c);
+        } else {
+            ring.drop_oldest(1);
+        }
+    }
+    ring.push(sample);
+}
@@ -0,0 +1,109 @@
+/*
+History_view remembers how each object's health and amount have changed
+over time, so they can be looked at later without replaying the run.
+Each object's values are kept in a few tiers of fixed-size ring buffers.
+New values go into the first tier, one per tick; when a tier fills up, its
+oldest few samples are averaged into one sample of the next, coarser tier,
+and the last tier simply drops its oldest. So recent history is kept in
+full, older history more and more roughly, and however long the run lasts,
+no object's history ever takes more than a fixed amount of memory. The
+history of an object is dropped when the object is gone.
+*/
+#ifndef HISTORY_VIEW_H
+#define HISTORY_VIEW_H
+
+#include "View.h"
+#include <string>
+#include <vector>//samples in a ring, tiers
+#include <map>//objects' histories
+#include <iosfwd>//ostream
+
+class Model;
+
+class History_view : public View {
+public:
+    //Starts with no histories; samples are timed by the given world's clock
+    History_view(const Model& model_);
+    
+    //Only wants health, amounts and removals
+    int get_interests() const override
+        {return HEALTH_INTEREST | AMOUNT_INTEREST | GONE_INTEREST;}
+    
+    //Adds the value to the object's history, at the current time
+    void update_health(const std::string& name, double health) override;
+    void update_amount(const std::string& name, double amount) override;
+    //Forgets the object's history
+    void update_remove(const std::string& name) override;
+    
+    //Forgets every object's history
+    void clear() override;
+    
+    //Writes a sparkline of each of the object's histories to os, and if
+    //full is true, every sample as well.
+    //Throws Error("No history for that object!") if there is none.
+    void describe(const std::string& name, bool full, std::ostream& os) const;
+    
+    //Returns the internal representation of the view's name
+    std::string get_name() override;
+    
+private:
+    //A value, and the first tick it stands for; a coarser sample stands
+    //for the average of the ticks up to the next sample
+    struct Sample {
+        int tick;
+        double value;
+    };
+    
+    //Holds up to a fixed number of samples, oldest first. Storage grows
+    //as samples arrive until the ring first fills, and never after.
+    class Sample_ring {
+    public:
+        Sample_ring() : oldest(0), count(0) {}
+        int size() const {return count;}
+        bool empty() const {return count == 0;}
+        bool full() const;
+        //returns the sample at the index, counting from the oldest
+        const Sample& operator[](int index) const;
+        Sample& newest();
+        //adds the sample after the newest; the ring must not be full
+        void push(Sample sample);
+        //drops the given number of oldest samples; the ring must be full
+        void drop_oldest(int dropped);
+    private:
+        std::vector<Sample> samples;
+        int oldest;//index in samples of the oldest sample
+        int count;
+    };
+    
+    //The tiers of one value's history; tiers[0] has the newest samples
+    class Series {
+    public:
+        Series();
+        bool empty() const {return tiers.front().empty();}
+        //records the value for the tick, replacing any value recorded for
+        //the same tick
+        void add(int tick, double value);
+        //returns every sample, oldest first
+        std::vector<Sample> get_samples() const;
+    private:
+        std::vector<Sample_ring> tiers;
+        //pushes the sample into the tier, first making room by averaging
+        //its oldest samples into the next tier, or dropping its oldest
+        void push(int tier, Sample sample);
+    };
+    
+    struct Object_history {
+        Series health;
+        Series amount;
+    };
+    
+    const Model& model;
+    std::map<std::string, Object_history> histories;
+    
+    //Writes a line for the series under the label, if it has any samples
+    static void describe_series(const std::string& label,
+                                const Series& series, bool full,
+                                std::ostream& os);
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "Image_writer.h"
+#include "Binary_writer.h"
+#include "Utility.h"
+#include <cmath>//floor
+#include <cstring>//strcmp
+#include <algorithm>//min, max
+#include <cstdint>
+
+using std::string;
+using std::vector;
+using std::to_string;
+
+const int max_image_side_c = 1 << 16;
+
+//The colour of each type of object; anything else is grey
+struct Type_color {
+    const char* type;
+    uint8_t rgb[3];
+};
+const Type_color type_colors_c[] = {
+    {"Soldier", {255, 64, 64}},
+    {"Archer", {255, 160, 0}},
+    {"Peasant", {64, 160, 255}},
+    {"Farm", {64, 224, 64}},
+    {"Town_Hall", {255, 255, 255}}
+};
+const uint8_t other_type_rgb_c[3] = {160, 160, 160};
+
+//Returns the red, green and blue of the named type
+const uint8_t* get_type_rgb(const char* type);
+
+//Finds the bounds of the points, then the size of a pixel that fits them
+//into the image both ways. Sorts the points into rows and writes the rows
+//from the top down.
+void write_ppm_image(const string& filename, int width, int height,
+                     const vector<Image_point>& points)
+{
+    if(width <= 0 || height <= 0) {
+        throw Error{"Image size must be positive!"};
+    }
+    if(width > max_image_side_c || height > max_image_side_c) {
+        throw Error{"Image size is too big!"};
+    }
+    Binary_writer writer(filename);
+    string header = "P6\n" + to_string(width) + " " + to_string(height) +
+                    "\n255\n";
+    writer.append(header.data(), header.size());
+    
+    Point lowest{0., 0.}, highest{0., 0.};
+    if(!points.empty()) {
+        lowest = highest = points.front().location;
+    }
+    for(const Image_point& point : points) {
+        lowest.x = std::min(lowest.x, point.location.x);
+        lowest.y = std::min(lowest.y, point.location.y);
+        highest.x = std::max(highest.x, point.location.x);
+        highest.y = std::max(highest.y, point.location.y);
+    }
+    //one pixel's width in the world; the points on the far edges land in
+    //the last pixels rather than past them
+    double pixel_size = std::max((highest.x - lowest.x) /
+                                     std::max(width - 1, 1),
+                                 (highest.y - lowest.y) /
+                                     std::max(height - 1, 1));
+    if(pixel_size <= 0.) {
+        pixel_size = 1.;//every point in the same place, or none at all
+    }
+    
+    //counting sort of the points by the row they fall in, top row first
+    vector<int> columns(points.size());
+    vector<int> row_starts(height + 1, 0);
+    vector<int> rows(points.size());
+    for(std::size_t index = 0; index < points.size(); index++) {
+        const Point& location = points[index].location;
+        columns[index] = std::min(width - 1, static_cast<int>(
+            floor((location.x - lowest.x) / pixel_size)));
+        rows[index] = height - 1 - std::min(height - 1, static_cast<int>(
+            floor((location.y - lowest.y) / pixel_size)));
+        row_starts[rows[index] + 1]++;
+    }
+    for(int row = 0; row < height; row++) {
+        row_starts[row + 1] += row_starts[row];
+    }
+    vector<int> by_row(points.size());
+    vector<int> next_in_row(row_starts.begin(), row_starts.end() - 1);
+    for(std::size_t index = 0; index < points.size(); index++) {
+        by_row[next_in_row[rows[index]]++] = static_cast<int>(index);
+    }
+    
+    vector<uint8_t> pixels(width * 3);
+    for(int row = 0; row < height; row++) {
+        std::fill(pixels.begin(), pixels.end(), 0);
+        for(int slot = row_starts[row]; slot < row_starts[row + 1]; slot++) {
+            int index = by_row[slot];
+            const uint8_t* rgb = get_type_rgb(points[index].type);
+            std::copy(rgb, rgb + 3, pixels.begin() + columns[index] * 3);
+        }
+        writer.append(pixels.data(), pixels.size());
+    }
+}
+
+//Looks through the few known types
+const uint8_t* get_type_rgb(const char* type)
+{
+    if(type) {
+        for(const Type_color& type_color : type_colors_c) {
+            if(std::strcmp(type, type_color.type) == 0) {
+                return type_color.rgb;
+            }
+        }
+    }
+    return other_type_rgb_c;
+}
@@ -0,0 +1,33 @@
+/*
+Image_writer draws where every object in the world is as a binary PPM
+image, one pixel per object, coloured by the object's type, on a black
+background. The image covers the smallest area holding every object,
+keeping its proportions, with the highest y at the top.
+
+Rows are written one at a time: the objects are first sorted into rows
+with a counting sort, and then each row is filled in and handed to the
+file, so only one row of pixels is ever in memory, however big the image.
+
+File format: the "P6" header in text, "P6\n<width> <height>\n255\n",
+then height rows of width pixels, each three bytes of red, green and blue.
+*/
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include "Geometry.h"//Point
+#include <string>
+#include <vector>
+
+//An object to draw: where it is, and the name of its type
+struct Image_point {
+    Point location;
+    const char* type;
+};
+
+//Writes the points to the named file as a width by height PPM image.
+//Throws Error("Image size must be positive!") if either is not, or
+//Error("Could not open output file!") if the file can't be opened.
+void write_ppm_image(const std::string& filename, int width, int height,
+                     const std::vector<Image_point>& points);
+
+#endif
@@ -0,0 +1,94 @@
+#include "Journal.h"
+#include "Utility.h"
+#include <chrono>//group commit window
+
+using std::string;
+using std::vector;
+using std::unique_lock;
+using std::mutex;
+
+//how long the first record of a group waits for others to join it
+const std::chrono::milliseconds journal_commit_window_c(2);
+//a group this large is committed without waiting any longer
+const std::size_t journal_group_size_c = 256;
+
+//Opens the file at its end, so a journal can be carried on after a restart
+Journal::Journal(const string& filename) :
+file(filename.c_str(), std::ios::out | std::ios::app), appended(0),
+committed(0), failed(false), stopping(false)
+{
+    if(!file) {
+        throw Error{"Could not open output file!"};
+    }
+    writer = std::thread(&Journal::run, this);
+}
+
+//Tells the writer thread to commit what is left and waits for it
+Journal::~Journal()
+{
+    {
+        unique_lock<mutex> lock(records_mutex);
+        stopping = true;
+    }
+    records_waiting.notify_one();
+    writer.join();
+}
+
+//The writer only needs waking for the first record of a group, or when a
+//group has filled up
+void Journal::append(const string& record)
+{
+    unique_lock<mutex> lock(records_mutex);
+    if(failed) {
+        throw Error{"Could not write journal!"};
+    }
+    pending.push_back(record);
+    appended++;
+    if(pending.size() == 1 || pending.size() == journal_group_size_c) {
+        records_waiting.notify_one();
+    }
+}
+
+//Waits for the writer to get past the last record appended so far
+void Journal::sync()
+{
+    unique_lock<mutex> lock(records_mutex);
+    long long target = appended;
+    records_committed.wait(lock, [this, target]() {
+        return committed >= target || failed;
+    });
+}
+
+//Takes the whole group at once, and writes it as one block with the lock
+//released, so appending never waits for the disk
+void Journal::run()
+{
+    unique_lock<mutex> lock(records_mutex);
+    while(true) {
+        records_waiting.wait(lock, [this]() {
+            return !pending.empty() || stopping;
+        });
+        if(pending.empty()) {
+            return;//stopping, with nothing left to commit
+        }
+        records_waiting.wait_for(lock, journal_commit_window_c, [this]() {
+            return pending.size() >= journal_group_size_c || stopping;
+        });
+        vector<string> group;
+        group.swap(pending);
+        long long group_end = appended;
+        lock.unlock();
+        string block;
+        for(const string& record : group) {
+            block += record;
+            block += '\n';
+        }
+        file.write(block.data(), block.size());
+        file.flush();
+        bool write_failed = !file;
+        lock.lock();
+        committed = group_end;
+        failed = failed || write_failed;
+        records_committed.notify_all();
+    }
+}
@@ -0,0 +1,61 @@
+/*
+Journal is a write-ahead log: an append-only text file of records, one per
+line, for replaying later. Appending only hands the record to a writer
+thread and returns, so the simulation never waits on the disk.
+
+The writer thread commits records in groups. Once a record arrives, it
+waits a moment for others to join it, then writes and flushes the whole
+group at once; however fast records arrive, the disk sees one write per
+group rather than one per record. A crash loses at most the records of the
+last group, and a record cut short by one is left without its newline, so
+whoever replays the file can tell it was never committed.
+*/
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class Journal {
+public:
+    //Opens the file for appending, creating it if needed, and starts the
+    //writer thread. Throws Error("Could not open output file!") if it can't.
+    Journal(const std::string& filename);
+    //Commits whatever is still pending, then stops the writer thread
+    ~Journal();
+
+    //Hands the record to the writer thread; returns at once. The record
+    //must not contain a newline.
+    //Throws Error("Could not write journal!") if an earlier write failed.
+    void append(const std::string& record);
+
+    //Waits until every record appended so far has been committed
+    void sync();
+
+private:
+    std::ofstream file;
+    std::mutex records_mutex;
+    std::condition_variable records_waiting;//signalled to the writer
+    std::condition_variable records_committed;//signalled by the writer
+    std::vector<std::string> pending;
+    long long appended;//records appended since the file was opened
+    long long committed;//of those, how many have been written and flushed
+    bool failed;
+    bool stopping;
+    std::thread writer;
+
+    //Commits groups of records as they arrive until told to stop
+    void run();
+
+	// disallow copy/move construction or assignment
+	Journal(const Journal&) = delete;
+	Journal& operator= (const Journal&)  = delete;
+	Journal(Journal&&) = delete;
+	Journal& operator= (Journal&&) = delete;
+};
+
+#endif
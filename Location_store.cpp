@@ -0,0 +1,131 @@
+#include "Location_store.h"
+
+using std::string;
+using std::vector;
+using std::set;
+using std::function;
+
+//Creates an empty store with the given size of grid cell
+Location_store::Location_store(double cell_size_) : cell_size(cell_size_)
+{
+}
+
+//Records the new location, moving the name to a new cell if needed
+void Location_store::update(const string& name, Point location)
+{
+    auto loc_iter = locations.find(name);
+    if(loc_iter == locations.end()) {
+        locations.insert(make_pair(name, location));
+        cells[get_grid_key(location, cell_size)].insert(name);
+        return;
+    }
+    Grid_key old_key = get_grid_key(loc_iter->second, cell_size);
+    Grid_key new_key = get_grid_key(location, cell_size);
+    loc_iter->second = location;
+    if(old_key == new_key) {
+        return;//most updates don't leave their cell
+    }
+    auto cell_iter = cells.find(old_key);
+    cell_iter->second.erase(name);
+    if(cell_iter->second.empty()) {
+        cells.erase(cell_iter);
+    }
+    cells[new_key].insert(name);
+}
+
+//Removes the name from the map and from its cell
+void Location_store::remove(const string& name)
+{
+    auto loc_iter = locations.find(name);
+    if(loc_iter == locations.end()) {
+        return;
+    }
+    auto cell_iter = cells.find(get_grid_key(loc_iter->second, cell_size));
+    cell_iter->second.erase(name);
+    if(cell_iter->second.empty()) {
+        cells.erase(cell_iter);
+    }
+    locations.erase(loc_iter);
+}
+
+//Looks the name up; returns false if it is not in the store
+bool Location_store::get_location(const string& name, Point& location) const
+{
+    auto loc_iter = locations.find(name);
+    if(loc_iter == locations.end()) {
+        return false;
+    }
+    location = loc_iter->second;
+    return true;
+}
+
+//Visits each cell overlapping the region, keeping only the objects that are
+//actually inside it. If the region covers more cells than there are
+//objects, it is cheaper to just check every object.
+vector<Location_store::Located_object>
+Location_store::get_objects_in(const Region& region) const
+{
+    vector<Located_object> result;
+    long long lo_x, lo_y, hi_x, hi_y;
+    get_grid_coords(region.lower_left, cell_size, lo_x, lo_y);
+    get_grid_coords(region.upper_right, cell_size, hi_x, hi_y);
+    double num_cells = double(hi_x - lo_x + 1) * double(hi_y - lo_y + 1);
+    if(num_cells > cells.size()) {
+        for(const auto& loc_pair : locations) {
+            if(region.contains(loc_pair.second)) {
+                result.push_back(loc_pair);
+            }
+        }
+        return result;
+    }
+    for(long long cx = lo_x; cx <= hi_x; cx++) {
+        for(long long cy = lo_y; cy <= hi_y; cy++) {
+            auto cell_iter = cells.find(make_grid_key(cx, cy));
+            if(cell_iter == cells.end()) {
+                continue;
+            }
+            for(const string& name : cell_iter->second) {
+                Point location = locations.find(name)->second;
+                if(region.contains(location)) {
+                    result.push_back(make_pair(name, location));
+                }
+            }
+        }
+    }
+    return result;
+}
+
+//Searches ever larger squares around the location, starting with one cell.
+//Once the nearest candidate is nearer than the square's half-width, nothing
+//outside the square can be as near; once the square holds every object,
+//there is nothing else to find. Of equally near objects, the one whose
+//name comes first wins, whatever order they are found in.
+bool Location_store::find_nearest(Point location,
+                                  const function<bool(const string&)>& accept,
+                                  Located_object& nearest) const
+{
+    for(double half_width = cell_size; ; half_width *= 2.) {
+        Region square{Point{location.x - half_width, location.y - half_width},
+                      Point{location.x + half_width, location.y + half_width}};
+        vector<Located_object> found = get_objects_in(square);
+        bool any_found = false;
+        double nearest_distance = 0.;
+        for(const Located_object& candidate : found) {
+            double distance = cartesian_distance(location, candidate.second);
+            if(any_found && (distance > nearest_distance ||
+                             (distance == nearest_distance &&
+                              candidate.first > nearest.first))) {
+                continue;
+            }
+            if(accept(candidate.first)) {
+                nearest = candidate;
+                nearest_distance = distance;
+                any_found = true;
+            }
+        }
+        if((any_found && nearest_distance < half_width) ||
+           found.size() == locations.size()) {
+            return any_found;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/*
+Location_store keeps the current location of every object in the world.
+Model owns the one and only store and keeps it up to date; Tile_views are just
+windows onto it, and pull the objects they need when they are asked to draw.
+Besides the name-to-location map, the store indexes every object by the square
+grid cell it sits in, so the objects inside a small region can be found without
+looking at the whole world.
+*/
+#ifndef LOCATION_STORE_H
+#define LOCATION_STORE_H
+
+#include "Spatial_grid.h"//Region, grid cells
+#include <string>
+#include <map>//name-to-location map
+#include <set>//names in a cell
+#include <unordered_map>//cells of the grid
+#include <vector>//query results
+#include <utility>//pair
+#include <functional>//function
+
+class Location_store {
+public:
+    typedef std::pair<std::string, Point> Located_object;
+
+    //Creates an empty store whose grid cells are cell_size_ units across
+    Location_store(double cell_size_);
+
+    //Saves the location of the named object, replacing any previous one
+    void update(const std::string& name, Point location);
+
+    //Forgets the named object; no error if the name is not present
+    void remove(const std::string& name);
+
+    //If the named object is present, sets location to where it is and
+    //returns true; otherwise returns false and leaves location alone.
+    bool get_location(const std::string& name, Point& location) const;
+
+    //Returns every object inside the region, in no particular order.
+    //Only the grid cells overlapping the region are examined.
+    std::vector<Located_object> get_objects_in(const Region& region) const;
+    
+    //Finds the object nearest the location among those whose names accept
+    //returns true for, choosing the first name of any that are equally
+    //near. If there is one, sets nearest to it and returns true;
+    //otherwise returns false.
+    bool find_nearest(Point location,
+                      const std::function<bool(const std::string&)>& accept,
+                      Located_object& nearest) const;
+
+    //Returns every object in the world, ordered by name
+    const std::map<std::string, Point>& get_all() const
+    {return locations;}
+
+    //Returns the number of objects in the store
+    int size() const {return static_cast<int>(locations.size());}
+
+private:
+    double cell_size;
+    std::map<std::string, Point> locations;
+    std::unordered_map<Grid_key, std::set<std::string>> cells;
+};
+
+#endif
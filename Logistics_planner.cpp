@@ -0,0 +1,286 @@
+#include "Logistics_planner.h"
+#include "Peasant.h"
+#include "Farm.h"
+#include "Town_Hall.h"
+#include "Geometry.h"
+#include "Location_store.h"
+#include "Utility.h"
+#include <ostream>//endl
+#include <queue>//priority_queue
+#include <cmath>//ceil
+#include <utility>//pair
+#include <algorithm>//max, min
+
+using std::string;
+using std::vector;
+using std::map;
+using std::pair;
+using std::make_pair;
+using std::shared_ptr;
+using std::weak_ptr;
+using std::dynamic_pointer_cast;
+using std::priority_queue;
+using std::endl;
+
+//a Farm's stock counts as if it were spread over this many ticks
+const double planning_horizon_c = 50.;
+//routes gaining less than this per tick from another Peasant are full
+const double min_gain_c = 0.01;
+//size of the grid cells used to find the idle Peasant nearest a Farm
+const double idle_cell_size_c = 8.;
+
+//Sorts the agents and structures by kind, keeping the ones we can use
+Logistics_planner::Logistics_planner(const vector<shared_ptr<Agent>>& agents,
+                                     const vector<shared_ptr<Structure>>& structures,
+                                     std::ostream& output_) :
+changed(false), output(output_)
+{
+    for(shared_ptr<Agent> agent : agents) {
+        shared_ptr<Peasant> peasant = dynamic_pointer_cast<Peasant>(agent);
+        if(peasant && peasant->is_alive()) {
+            assignments.insert(make_pair(peasant->get_name(),
+                                         Assignment{peasant, -1, 0.}));
+        }
+    }
+    if(assignments.empty()) {
+        throw Error{"No Peasants to plan for!"};
+    }
+    for(shared_ptr<Structure> structure : structures) {
+        shared_ptr<Town_Hall> hall = dynamic_pointer_cast<Town_Hall>(structure);
+        if(hall) {
+            halls.push_back(hall);
+        }
+    }
+    for(shared_ptr<Structure> structure : structures) {
+        shared_ptr<Farm> farm = dynamic_pointer_cast<Farm>(structure);
+        if(farm) {
+            routes.push_back(make_route(farm));
+        }
+    }
+}
+
+//Frees every route and Peasant, assigns them all again, and stops the
+//Peasants that weren't needed
+void Logistics_planner::plan()
+{
+    for(Route& route : routes) {
+        route_to_nearest_hall(route);
+        route.capacity = route.farm->get_production_rate() +
+            route.farm->get_amount() / planning_horizon_c;
+        route.spare = route.capacity;
+        route.rerouted = false;
+    }
+    for(auto& assignment_pair : assignments) {
+        assignment_pair.second.route = -1;
+        assignment_pair.second.rate = 0.;
+    }
+    assign_idle();
+    {
+        Output_muter muter(output);
+        for(auto& assignment_pair : assignments) {
+            shared_ptr<Peasant> peasant =
+                assignment_pair.second.peasant.lock();
+            if(peasant && assignment_pair.second.route < 0) {
+                peasant->stop();
+            }
+        }
+    }
+    changed = false;
+    print_summary("planned");
+}
+
+//A new Farm brings a route of its own; a new Town_Hall may shorten
+//existing routes
+void Logistics_planner::add_structure(shared_ptr<Structure> structure)
+{
+    shared_ptr<Town_Hall> hall = dynamic_pointer_cast<Town_Hall>(structure);
+    if(hall) {
+        halls.push_back(hall);
+        for(Route& route : routes) {
+            if(route_to_nearest_hall(route)) {
+                route.rerouted = true;
+                changed = true;
+            }
+        }
+        return;
+    }
+    shared_ptr<Farm> farm = dynamic_pointer_cast<Farm>(structure);
+    if(farm) {
+        routes.push_back(make_route(farm));
+        changed = true;
+    }
+}
+
+//The Peasant's share of its route becomes spare again
+void Logistics_planner::remove_peasant(const string& name)
+{
+    auto assignment_iter = assignments.find(name);
+    if(assignment_iter == assignments.end()) {
+        return;
+    }
+    if(assignment_iter->second.route >= 0) {
+        routes[assignment_iter->second.route].spare +=
+            assignment_iter->second.rate;
+        changed = true;
+    }
+    assignments.erase(assignment_iter);
+}
+
+//Peasants already working where nothing changed are left alone
+void Logistics_planner::replan()
+{
+    if(!changed) {
+        return;
+    }
+    changed = false;
+    apply_reroutes();
+    assign_idle();
+    print_summary("re-planned");
+}
+
+//A new route starts with all of its capacity spare
+Logistics_planner::Route
+Logistics_planner::make_route(shared_ptr<Farm> farm) const
+{
+    double capacity = farm->get_production_rate() +
+        farm->get_amount() / planning_horizon_c;
+    Route route{farm, nullptr, 0., capacity, capacity, false};
+    route_to_nearest_hall(route);
+    return route;
+}
+
+//There are few Town_Halls, so each is checked
+bool Logistics_planner::route_to_nearest_hall(Route& route) const
+{
+    Point farm_location = route.farm->get_location();
+    shared_ptr<Town_Hall> nearest = route.hall;
+    double nearest_distance = nearest ?
+        cartesian_distance(farm_location, nearest->get_location()) : 0.;
+    for(shared_ptr<Town_Hall> hall : halls) {
+        double distance = cartesian_distance(farm_location,
+                                             hall->get_location());
+        if(!nearest || distance < nearest_distance) {
+            nearest = hall;
+            nearest_distance = distance;
+        }
+    }
+    if(nearest == route.hall) {
+        return false;
+    }
+    route.hall = nearest;
+    route.trip_length = nearest_distance;
+    return true;
+}
+
+//A round trip is the moves there and back, plus one update each to
+//collect and to deposit
+double Logistics_planner::delivery_rate(const Route& route,
+                                        double speed) const
+{
+    if(!route.hall || speed <= 0.) {
+        return 0.;
+    }
+    double trip_time = 2. * ceil(route.trip_length / speed) + 2.;
+    return Peasant::get_capacity() / trip_time;
+}
+
+//Routes are kept in a heap by what one more Peasant would add, assuming the
+//fastest idle Peasant; the route on top gets the idle Peasant nearest its
+//Farm, which keeps the walk to start working short. Each route is in the
+//heap at most once, so no entry is ever stale.
+int Logistics_planner::assign_idle()
+{
+    Location_store idle(idle_cell_size_c);
+    double fastest = 0.;
+    for(auto& assignment_pair : assignments) {
+        shared_ptr<Peasant> peasant = assignment_pair.second.peasant.lock();
+        if(peasant && peasant->is_alive() &&
+           assignment_pair.second.route < 0) {
+            idle.update(assignment_pair.first, peasant->get_location());
+            fastest = std::max(fastest, peasant->get_speed());
+        }
+    }
+    priority_queue<pair<double, int>> gains;
+    for(int i = 0; i < static_cast<int>(routes.size()); i++) {
+        double gain = std::min(delivery_rate(routes[i], fastest),
+                               routes[i].spare);
+        if(gain >= min_gain_c) {
+            gains.push(make_pair(gain, i));
+        }
+    }
+    int assigned = 0;
+    Output_muter muter(output);
+    while(!gains.empty() && idle.size() > 0) {
+        Route& route = routes[gains.top().second];
+        int route_index = gains.top().second;
+        gains.pop();
+        Location_store::Located_object nearest;
+        idle.find_nearest(route.farm->get_location(),
+                          [](const string&) {return true;}, nearest);
+        idle.remove(nearest.first);
+        Assignment& assignment = assignments.find(nearest.first)->second;
+        shared_ptr<Peasant> peasant = assignment.peasant.lock();
+        assignment.route = route_index;
+        assignment.rate = std::min(delivery_rate(route, peasant->get_speed()),
+                                   route.spare);
+        route.spare -= assignment.rate;
+        peasant->start_working(route.farm, route.hall);
+        assigned++;
+        double gain = std::min(delivery_rate(route, fastest), route.spare);
+        if(gain >= min_gain_c) {
+            gains.push(make_pair(gain, route_index));
+        }
+    }
+    return assigned;
+}
+
+//Peasants keep their Farm but carry to the new Town_Hall, and the route's
+//spare capacity is worked out again at the new delivery rates; any that
+//are no longer needed there become idle
+void Logistics_planner::apply_reroutes()
+{
+    for(Route& route : routes) {
+        if(route.rerouted) {
+            route.spare = route.capacity;
+        }
+    }
+    Output_muter muter(output);
+    for(auto& assignment_pair : assignments) {
+        Assignment& assignment = assignment_pair.second;
+        shared_ptr<Peasant> peasant = assignment.peasant.lock();
+        if(!peasant || assignment.route < 0 ||
+           !routes[assignment.route].rerouted) {
+            continue;
+        }
+        Route& route = routes[assignment.route];
+        if(route.spare < min_gain_c) {
+            assignment.route = -1;//the shorter trips need fewer Peasants
+            assignment.rate = 0.;
+            peasant->stop();
+            continue;
+        }
+        assignment.rate = std::min(delivery_rate(route, peasant->get_speed()),
+                                   route.spare);
+        route.spare -= assignment.rate;
+        peasant->start_working(route.farm, route.hall);
+    }
+    for(Route& route : routes) {
+        route.rerouted = false;
+    }
+}
+
+//Adds up what the working Peasants are expected to deliver
+void Logistics_planner::print_summary(const char* what) const
+{
+    double planned = 0.;
+    int working = 0;
+    for(const auto& assignment_pair : assignments) {
+        if(assignment_pair.second.route >= 0) {
+            planned += assignment_pair.second.rate;
+            working++;
+        }
+    }
+    output << "Logistics " << what << ": " << planned << " food per tick, "
+        << working << " Peasants working, "
+        << assignments.size() - working << " idle" << endl;
+}
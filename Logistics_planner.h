@@ -0,0 +1,97 @@
+/*
+Logistics_planner decides which Farm each of a set of Peasants should work,
+and which Town_Hall it should carry that Farm's food to, so that as much food
+as possible is delivered per tick.
+
+Each Farm is worked as a route to its nearest Town_Hall. A route can supply
+the Farm's production rate plus its current stock spread over a planning
+horizon; a Peasant on it delivers a load per round trip, so routes to nearby
+Town_Halls are worth more per Peasant. Planning is greedy: the route that
+would gain the most from one more Peasant gets the idle Peasant nearest its
+Farm, until the Peasants or the routes' spare capacity run out. Peasants
+left over are told to stop.
+
+Model owns the planner while automatic work is on. It tells the planner when
+structures are built and when agents are removed, and asks it to re-plan
+after each update. Re-planning only touches what changed: a new Farm or a
+Peasant's death frees capacity for idle Peasants, and a new Town_Hall
+reroutes just the Farms it is nearer to.
+*/
+#ifndef LOGISTICS_PLANNER_H
+#define LOGISTICS_PLANNER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <iosfwd>//ostream
+
+class Agent;
+class Peasant;
+class Structure;
+class Farm;
+class Town_Hall;
+
+class Logistics_planner {
+public:
+    //Takes charge of the Peasants among agents, and the Farms and
+    //Town_Halls among structures. Throws Error("No Peasants to plan for!")
+    //if there are no living Peasants. Summaries are written to output_,
+    //which is muted while the Peasants are given their orders.
+    Logistics_planner(const std::vector<std::shared_ptr<Agent>>& agents,
+                      const std::vector<std::shared_ptr<Structure>>& structures,
+                      std::ostream& output_);
+
+    //Assigns every Peasant from scratch, and outputs a summary
+    void plan();
+
+    //Includes the structure in the next re-plan if it is a Farm or a
+    //Town_Hall; other structures are ignored
+    void add_structure(std::shared_ptr<Structure> structure);
+
+    //Forgets the named Peasant, freeing its share of its route;
+    //no error if it is not one of ours
+    void remove_peasant(const std::string& name);
+
+    //If anything has changed since the last plan, reroutes Farms that now
+    //have a nearer Town_Hall, puts idle Peasants to work wherever there is
+    //spare capacity, and outputs a summary
+    void replan();
+
+private:
+    struct Route {
+        std::shared_ptr<Farm> farm;
+        std::shared_ptr<Town_Hall> hall;//nullptr until there is a Town_Hall
+        double trip_length;//from the Farm to the Town_Hall
+        double capacity;//food per tick the Farm can supply
+        double spare;//capacity not yet claimed by a Peasant
+        bool rerouted;//the Town_Hall has changed since the last plan
+    };
+    struct Assignment {
+        std::weak_ptr<Peasant> peasant;
+        int route;//index into routes, or -1 if idle
+        double rate;//food per tick it is expected to deliver
+    };
+
+    std::vector<std::shared_ptr<Town_Hall>> halls;
+    std::vector<Route> routes;
+    std::map<std::string, Assignment> assignments;
+    bool changed;
+    std::ostream& output;
+
+    //Creates a route for the Farm to its nearest Town_Hall
+    Route make_route(std::shared_ptr<Farm> farm) const;
+    //points the route at its nearest Town_Hall; returns true if that changed
+    bool route_to_nearest_hall(Route& route) const;
+    //food per tick one Peasant moving at speed delivers along the route
+    double delivery_rate(const Route& route, double speed) const;
+    //Gives idle Peasants to the routes with the most to gain;
+    //returns the number put to work
+    int assign_idle();
+    //Has each Peasant on a rerouted route carry to its new Town_Hall
+    void apply_reroutes();
+    //outputs the food planned per tick, and how many Peasants are busy
+    void print_summary(const char* what) const;
+};
+
+#endif
@@ -7,9 +7,27 @@
 #include "Agent.h"
 #include "Structure.h"
 #include "Utility.h"
+#include "Location_store.h"
+#include "Region_index.h"
+#include "Renderer.h"
+#include "Trace_writer.h"
+#include "Logistics_planner.h"
+#include "Flow_field.h"
+#include "Task_queue.h"
+#include "Image_writer.h"
+#include "State_hash.h"
+#include "Binary_writer.h"
+#include "Binary_reader.h"
+#include "Spatial_grid.h"//Region
+#include <iostream>//cout, the default output
+#include <ostream>//endl
 #include <functional>//bind
-#include <algorithm>//for_each
+#include <algorithm>//for_each, sort
 #include <utility>//make_pair
+#include <cstdio>//rename
+#include <cstring>//memcmp
+#include <thread>//snapshot writer
+#include <atomic>
 
 using std::string;
 using std::for_each;
@@ -17,21 +35,115 @@ using std::mem_fn;
 using std::map;
 using std::bind;
 using std::list;
+using std::vector;
 using std::shared_ptr;
+using std::unique_ptr;
 using std::any_of;
+using std::sort;
 using std::dynamic_pointer_cast;
 using namespace std::placeholders;
 
 const int default_starting_time_c = 0;
+const double location_cell_size_c = 8.0;
+const double view_region_cell_size_c = 16.0;
+const double watch_cell_size_c = 8.0;
+const double flow_cell_size_c = 2.0;
+const int flow_radius_c = 64;//cells out from the destination
+const std::size_t min_flow_sweep_c = 64;
+//once this many more names are waiting to be hashed again than there are
+//objects, the next hash just works out every object's part afresh
+const std::size_t hash_backlog_slack_c = 1024;
+const char* const replan_task_c = "logistics";
+const char* const snapshot_magic_c = "P5SN";
+const char* const snapshot_end_c = "END";
+const uint16_t snapshot_version_c = 1;
+const std::size_t snapshot_alignment_c = 8;
+const char* const snapshot_temp_suffix_c = ".tmp";
 
-//Takes in a map of objects and returns the object whose distance is closest
-//to the given agent. Undefined behavior if not given a map of sim_objects. 
-template<typename T>
-shared_ptr<Sim_object> get_closest_object(shared_ptr<Agent> agent,
-                                          const T& obj_map);
+//Opens the snapshot and checks it is a complete one, returning a reader
+//positioned just after the header's padding.
+//Throws Error("Not a snapshot file!") if it isn't.
+Binary_reader open_snapshot(const string& filename);
+
+//What objects added together report while they broadcast their state
+struct Model::Batch {
+    map<string, Point> locations;
+    map<string, double> healths;
+    map<string, double> amounts;
+};
+
+//Fields are only held weakly, so one disappears once nothing is moving
+//along it; the entries left behind are swept out whenever the map has
+//doubled in size since the last sweep. The structures are kept in a store
+//of their own, so finding the obstacles near a field doesn't mean looking
+//through every agent near it too.
+struct Model::Flow_fields {
+    struct Less_than_point {
+        bool operator() (const Point& p1, const Point& p2) const
+            {return p1.x < p2.x || (p1.x == p2.x && p1.y < p2.y);}
+    };
+    map<Point, std::weak_ptr<Flow_field>, Less_than_point> fields;
+    //built when first needed, and dropped along with the fields
+    unique_ptr<Location_store> obstacles;
+    std::size_t sweep_size;
+
+    Flow_fields() : sweep_size(min_flow_sweep_c) {}
+};
+
+//A snapshot on its way to disk. The clone's messages go nowhere, and it is
+//only touched by the writer thread until done is set.
+struct Model::Snapshot_job {
+    std::ostream discard;
+    unique_ptr<Model> world;
+    std::thread writer;
+    std::atomic<bool> done;
+    string error;//why it could not be written, if it couldn't
+
+    Snapshot_job() : discard(nullptr), done(false) {}
+};
+
+//What changed while a checkpoint was the latest one: a copy of each object
+//as it was before its first change, along with the object itself, so agents
+//that die are kept to be brought back; and the names of objects added,
+//which have nothing to go back to.
+struct Model::Checkpoint {
+    struct Saved_state {
+        shared_ptr<Sim_object> object;
+        shared_ptr<Sim_object> state;
+    };
+    string label;
+    int time;
+    map<string, Saved_state> saved;
+    std::set<string> added;
+};
+
+//Views are filed by the changes they want. Views that only care about part
+//of the world get their location and gone updates through a Region_index
+//instead of the plain lists, so an update only reaches the views whose
+//region it falls in. Agents watching a region for newcomers are filed the
+//same way, by name.
+struct Model::Subscriptions {
+    list<shared_ptr<View>> location_views;
+    list<shared_ptr<View>> amount_views;
+    list<shared_ptr<View>> health_views;
+    list<shared_ptr<View>> gone_views;
+    Region_index<shared_ptr<View>> region_location_views;
+    Region_index<shared_ptr<View>> region_gone_views;
+    Region_index<string> watches;
 
+    Subscriptions() :
+    region_location_views(view_region_cell_size_c),
+    region_gone_views(view_region_cell_size_c),
+    watches(watch_cell_size_c)
+    {}
+};
+
+//Messages go to the console
+Model::Model() : Model(std::cout)
+{
+}
 //Initializes the initial objects, sets time to start at 0
-Model::Model() : time(default_starting_time_c)
+Model::Model(std::ostream& output_) : Model(output_, default_starting_time_c)
 {
     //initialize initial objects:
     insert_structure(create_structure("Rivendale", "Farm", Point(10., 10.)));
@@ -45,38 +157,247 @@ Model::Model() : time(default_starting_time_c)
     insert_agent(create_agent("Bug", "Soldier", Point(15., 20.)));
     insert_agent(create_agent("Iriel", "Archer", Point(20., 38.)));
 }
-//Returns the singleton instance
-Model& Model::get_instance()
+//Starts with no objects and no views
+Model::Model(std::ostream& output_, int time_) : output(output_), time(time_),
+locations(new Location_store(location_cell_size_c)),
+state_primed(false), trace_interval(0), objects_hash(0), hash_tracking(false),
+hash_interval(0),
+replan_posted(false), tasks(new Task_queue), subscriptions(new Subscriptions),
+flow_fields(new Flow_fields), epoch(0)
+{
+}
+//Waits for any snapshot still being written; declared here so
+//Location_store, Subscriptions, Batch, Flow_fields, Checkpoint, Snapshot_job,
+//Renderer, Trace_writer, Logistics_planner and Task_queue are complete when
+//destroyed
+Model::~Model()
+{
+    if(snapshot_job) {
+        snapshot_job->writer.join();
+    }
+}
+//Every object is copied before any is relinked, since they refer to each
+//other by pointer. The store, the last reported states and the watches are
+//copied whole rather than rebuilt, so the copy is exactly where this world
+//is, including objects that have not reported in yet.
+std::unique_ptr<Model> Model::clone(std::ostream& output_) const
+{
+    unique_ptr<Model> world(new Model(output_, time));
+    copy_objects(*world);
+    *world->locations = *locations;
+    world->healths = healths;
+    world->amounts = amounts;
+    world->state_primed = state_primed;
+    world->subscriptions->watches = subscriptions->watches;
+    world->tasks->set_budget(tasks->get_budget());
+    for_each(world->objects.begin(), world->objects.end(),
+             mem_fn(&Sim_object::relink));
+    return world;
+}
+
+//The maps are already in name order, so the copies go in with the same
+//hints add_structures and add_agents use
+void Model::copy_objects(Model& world) const
 {
-    static Model singleton_model;
-    return singleton_model;
+    vector<shared_ptr<Structure>> struct_copies;
+    struct_copies.reserve(structures.size());
+    for(const auto& struct_pair : structures) {
+        struct_copies.push_back(struct_pair.second->clone());
+    }
+    vector<shared_ptr<Agent>> agent_copies;
+    agent_copies.reserve(agents.size());
+    for(const auto& agent_pair : agents) {
+        agent_copies.push_back(agent_pair.second->clone());
+    }
+    world.insert_sorted(struct_copies, world.structures, false);
+    world.insert_sorted(agent_copies, world.agents, false);
 }
 
 //Inserts structure and has it broadcast its state
 void Model::add_structure(shared_ptr<Structure> structure)
 {
     insert_structure(structure);
+    note_added(structure->get_name());
     structure->broadcast_current_state();
+    invalidate_flow_fields();
+    if(logistics) {
+        logistics->add_structure(structure);
+        logistics->replan();
+    }
 }
 
 //Inserts the agent into containers and has it broadcast its state
 void Model::add_agent(shared_ptr<Agent> agent)
 {
     insert_agent(agent);
+    note_added(agent->get_name());
     agent->broadcast_current_state();
 }
+//Sorts the structures by name so they can be inserted in one pass,
+//then has each broadcast its state
+void Model::add_structures(vector<shared_ptr<Structure>> new_structures)
+{
+    sort(new_structures.begin(), new_structures.end(), Less_than_obj_ptr());
+    insert_sorted(new_structures, structures);
+    for(auto& structure : new_structures) {
+        note_added(structure->get_name());
+    }
+    broadcast_batch(new_structures);
+    invalidate_flow_fields();
+    if(logistics) {
+        for(auto& structure : new_structures) {
+            logistics->add_structure(structure);
+        }
+        logistics->replan();
+    }
+}
+
+//Sorts the agents by name so they can be inserted in one pass,
+//then has each broadcast its state
+void Model::add_agents(vector<shared_ptr<Agent>> new_agents)
+{
+    sort(new_agents.begin(), new_agents.end(), Less_than_obj_ptr());
+    insert_sorted(new_agents, agents);
+    for(auto& agent : new_agents) {
+        note_added(agent->get_name());
+    }
+    broadcast_batch(new_agents);
+}
+
+//std::map can't reserve room ahead of time, but inserting in order with
+//the previous position as a hint keeps each insertion amortized constant
+//when the new names aren't interleaved with existing ones
+template<typename T>
+void Model::insert_sorted(const vector<shared_ptr<T>>& sorted_objects,
+                          map<string, shared_ptr<T>>& name_map,
+                          bool update_locations)
+{
+    auto name_hint = name_map.end();
+    auto object_hint = objects.end();
+    for(auto& object : sorted_objects) {
+        name_hint = name_map.insert(name_hint,
+                                    make_pair(object->get_name(), object));
+        ++name_hint;
+        object_hint = objects.insert(object_hint, object);
+        ++object_hint;
+        object->set_model(this);
+        if(update_locations) {
+            locations->update(object->get_name(), object->get_location());
+        }
+    }
+}
+
+//While the batch exists, the notify functions only record what they hear,
+//so each view is told about the new objects once instead of once apiece
+template<typename T>
+void Model::broadcast_batch(const vector<shared_ptr<T>>& new_objects)
+{
+    batch.reset(new Batch);
+    for(auto& object : new_objects) {
+        object->broadcast_current_state();
+    }
+    unique_ptr<Batch> finished(batch.release());
+    View_snapshot snapshot{finished->locations, finished->healths,
+                           finished->amounts};
+    for(shared_ptr<View> view : views) {
+        view->sync(snapshot);
+    }
+}
+
 //Adds the structure to the map of structures; assumes none with same name
 void Model::insert_structure(shared_ptr<Structure> structure)
 {
+    structure->set_model(this);
     objects.insert(structure);
     structures.insert(make_pair(structure->get_name(), structure));
+    locations->update(structure->get_name(), structure->get_location());
 }
 
 //Adds the agent to the map of agents; assumes none with same name
 void Model::insert_agent(shared_ptr<Agent> agent)
 {
+    agent->set_model(this);
     objects.insert(agent);
     agents.insert(make_pair(agent->get_name(), agent));
+    locations->update(agent->get_name(), agent->get_location());
+}
+
+//Shares a live field if there is one, otherwise makes a new one with every
+//structure in its reach as an obstacle
+shared_ptr<const Flow_field> Model::get_flow_field(Point destination)
+{
+    auto& fields = flow_fields->fields;
+    auto field_iter = fields.find(destination);
+    if(field_iter != fields.end()) {
+        shared_ptr<Flow_field> field = field_iter->second.lock();
+        if(field) {
+            return field;
+        }
+    }
+    double reach = (flow_radius_c + 1) * flow_cell_size_c;
+    Region square{Point{destination.x - reach, destination.y - reach},
+                  Point{destination.x + reach, destination.y + reach}};
+    if(!flow_fields->obstacles) {
+        flow_fields->obstacles.reset(
+            new Location_store(location_cell_size_c));
+        for(const auto& struct_pair : structures) {
+            flow_fields->obstacles->update(struct_pair.first,
+                                           struct_pair.second->get_location());
+        }
+    }
+    vector<Point> obstacles;
+    for(const auto& located : flow_fields->obstacles->get_objects_in(square)) {
+        obstacles.push_back(located.second);
+    }
+    shared_ptr<Flow_field> field =
+        std::make_shared<Flow_field>(destination, flow_cell_size_c,
+                                     flow_radius_c, obstacles);
+    fields[destination] = field;
+    if(fields.size() > flow_fields->sweep_size) {
+        for(auto iter = fields.begin(); iter != fields.end();) {
+            if(iter->second.expired())
+                iter = fields.erase(iter);
+            else
+                ++iter;
+        }
+        flow_fields->sweep_size = std::max(min_flow_sweep_c,
+                                           2 * fields.size());
+    }
+    return field;
+}
+//Objects following a stale field will ask for a new one
+void Model::invalidate_flow_fields()
+{
+    for(auto& field_pair : flow_fields->fields) {
+        shared_ptr<Flow_field> field = field_pair.second.lock();
+        if(field) {
+            field->mark_stale();
+        }
+    }
+    flow_fields->fields.clear();
+    flow_fields->obstacles.reset();
+}
+
+//Copies the agents out of the name map
+vector<shared_ptr<Agent>> Model::get_all_agents() const
+{
+    vector<shared_ptr<Agent>> result;
+    result.reserve(agents.size());
+    for(const auto& agent_pair : agents) {
+        result.push_back(agent_pair.second);
+    }
+    return result;
+}
+
+//Copies the structures out of the name map
+vector<shared_ptr<Structure>> Model::get_all_structures() const
+{
+    vector<shared_ptr<Structure>> result;
+    result.reserve(structures.size());
+    for(const auto& structure_pair : structures) {
+        result.push_back(structure_pair.second);
+    }
+    return result;
 }
 
 //Returns the structure shared_ptr with the requested name.
@@ -95,6 +416,19 @@ bool Model::is_name_in_use(const string &name) const
 {//why redo code? :
     return is_agent_present(name) || is_structure_present(name);
 }
+//Looks among the agents first, since there are usually more of them
+const char* Model::get_type_name(const string& name) const
+{
+    auto agent_iter = agents.find(name);
+    if(agent_iter != agents.end()) {
+        return agent_iter->second->get_type_name();
+    }
+    auto struct_iter = structures.find(name);
+    if(struct_iter != structures.end()) {
+        return struct_iter->second->get_type_name();
+    }
+    return nullptr;
+}
 //Returns true if the structure with the name is present
 bool Model::is_structure_present(const string &name) const
 {
@@ -120,18 +454,552 @@ void Model::describe() const
     for_each(objects.begin(), objects.end(), mem_fn(&Sim_object::describe));
 }
 //calls the update function for each of the objects
-//increments the time
+//increments the time, and writes a trace block if one is due
 void Model::update()
 {
     time++;
     for_each(objects.begin(), objects.end(), mem_fn(&Sim_object::update));
+    resolve_hits();
+    if(logistics && !replan_posted) {
+        replan_posted = true;
+        post_task(replan_task_c, [this]() {
+            replan_posted = false;
+            if(logistics) {
+                logistics->replan();
+            }
+        });
+    }
+    tasks->run(time);
+    if(trace && time % trace_interval == 0) {
+        trace->write_block(time, locations->get_all(), healths, amounts);
+    }
+    if(hash_interval && time % hash_interval == 0) {
+        describe_state_hash();
+    }
+}
+//The queue decides when the task runs
+void Model::post_task(const string& kind, std::function<void()> task)
+{
+    tasks->post(kind, task, time);
+}
+//Tasks already waiting run on the next tick even if the budget is removed
+void Model::set_task_budget(int microseconds)
+{
+    tasks->set_budget(microseconds);
+}
+int Model::get_task_budget() const
+{
+    return tasks->get_budget();
+}
+//The queue keeps its own statistics
+void Model::describe_tasks() const
+{
+    tasks->describe(output);
+}
+//Hits are only recorded here; see resolve_hits
+void Model::queue_hit(shared_ptr<Agent> target, std::weak_ptr<Agent> attacker,
+                      int strength)
+{
+    hits.push_back(Hit{target, attacker, strength});
+}
+//Every Agent has struck before any is hurt, so who strikes first no
+//longer matters. Hits are grouped by target, in name order; within a
+//group they stay in the order they were made, and the first attacker is
+//the one the target reacts to.
+void Model::resolve_hits()
+{
+    std::stable_sort(hits.begin(), hits.end(),
+                     [](const Hit& hit1, const Hit& hit2) {
+        return hit1.target->get_name() < hit2.target->get_name();
+    });
+    for(auto first = hits.begin(); first != hits.end();) {
+        auto last = first;
+        int damage = 0;
+        for(; last != hits.end() && last->target == first->target; ++last) {
+            damage += last->strength;
+        }
+        shared_ptr<Agent> target = first->target;
+        if(target->is_alive()) {
+            target->take_hit(damage, first->attacker);
+            if(!target->is_alive()) {
+                for(auto hit = first; hit != last; ++hit) {
+                    shared_ptr<Agent> attacker = hit->attacker.lock();
+                    if(attacker && attacker->is_alive()) {
+                        attacker->target_killed(target);
+                    }
+                }
+            }
+        }
+        first = last;
+    }
+    hits.clear();//keeps its capacity for the next update
+}
+//Opens the trace file, making sure every object's state is known first;
+//the first block is written right away
+void Model::start_trace(const string& filename, int interval)
+{
+    trace.reset(new Trace_writer(filename));
+    trace_interval = interval;
+    prime_state();
+    trace->write_block(time, locations->get_all(), healths, amounts);
+}
+//Closing the writer flushes the file
+void Model::stop_trace()
+{
+    trace.reset();
+}
+//Only objects that have changed since the last time are hashed again: each
+//one's old part is XORed out and its new part in. An object that is no
+//longer in the world has no part. A name may have been noted more than
+//once, which just means its part is worked out twice. If changes weren't
+//being noted, every object's part is worked out from scratch instead.
+std::uint64_t Model::get_state_hash()
+{
+    if(!hash_tracking) {
+        object_hashes.clear();
+        objects_hash = 0;
+        changed_names.clear();
+        for(const auto& object : objects) {
+            changed_names.push_back(object->get_name());
+        }
+        hash_tracking = true;
+    }
+    for(const string& name : changed_names) {
+        shared_ptr<Sim_object> object;
+        auto agent_iter = agents.find(name);
+        if(agent_iter != agents.end()) {
+            object = agent_iter->second;
+        }
+        else {
+            auto struct_iter = structures.find(name);
+            if(struct_iter != structures.end()) {
+                object = struct_iter->second;
+            }
+        }
+        auto hash_iter = object_hashes.find(name);
+        if(hash_iter != object_hashes.end()) {
+            objects_hash ^= hash_iter->second;
+            object_hashes.erase(hash_iter);
+        }
+        if(object) {
+            State_hash object_hash;
+            object->hash_state(object_hash);
+            objects_hash ^= object_hash.get();
+            object_hashes.insert(make_pair(name, object_hash.get()));
+            object->set_hash_current();
+        }
+    }
+    changed_names.clear();
+    State_hash world_hash;
+    world_hash.add(time);
+    world_hash.add(objects_hash);
+    return world_hash.get();
+}
+//The first hash is output right away
+void Model::start_hash_trace(int interval)
+{
+    hash_interval = interval;
+    describe_state_hash();
+}
+//Nothing to close
+void Model::stop_hash_trace()
+{
+    hash_interval = 0;
+}
+//Nothing is kept until the hash has been asked for, and a backlog grown
+//bigger than the world is dropped, since hashing everything is no dearer;
+//the object may already have been noted, see get_state_hash
+void Model::note_changed(const string& name)
+{
+    if(!hash_tracking) {
+        return;
+    }
+    changed_names.push_back(name);
+    if(changed_names.size() > objects.size() + hash_backlog_slack_c) {
+        changed_names.clear();
+        hash_tracking = false;
+    }
+}
+//Always the same width, so runs can be compared line by line
+void Model::describe_state_hash()
+{
+    output << "Hash at time " << time << ": "
+        << format_hash(get_state_hash()) << std::endl;
+}
+/* Snapshot file format (all numbers in the machine's byte order):
+    header:   char[4] "P5SN", uint16_t version, then padding to 8 bytes,
+              int32_t tag, int32_t time,
+              uint32_t number of structures, uint32_t number of agents
+    then for each structure, then each agent, in name order:
+              type and name as uint16_t length and characters,
+              double x, double y
+    then the state of each, in the same order, as its write_state wrote it
+    then uint32_t number of watches, and for each: the watcher's name,
+              then the corners of its region as four doubles
+    trailer:  char[4] "END"
+Every object is listed before any state is read, so that objects can refer to
+each other by name. The file is written under another name and then renamed,
+so a snapshot cut short never replaces a complete one. */
+void Model::write_snapshot(const string& filename, int tag) const
+{
+    string temp_name = filename + snapshot_temp_suffix_c;
+    {
+        Binary_writer writer(temp_name);
+        writer.append(snapshot_magic_c, 4);
+        writer.put(snapshot_version_c);
+        writer.pad_to(snapshot_alignment_c);
+        writer.put(static_cast<int32_t>(tag));
+        writer.put(static_cast<int32_t>(time));
+        writer.put(static_cast<uint32_t>(structures.size()));
+        writer.put(static_cast<uint32_t>(agents.size()));
+        auto write_entry = [&writer](const Sim_object& object) {
+            writer.put_string(object.get_type_name());
+            writer.put_string(object.get_name());
+            writer.put(object.get_location().x);
+            writer.put(object.get_location().y);
+        };
+        for(const auto& struct_pair : structures) {
+            write_entry(*struct_pair.second);
+        }
+        for(const auto& agent_pair : agents) {
+            write_entry(*agent_pair.second);
+        }
+        for(const auto& struct_pair : structures) {
+            struct_pair.second->write_state(writer);
+        }
+        for(const auto& agent_pair : agents) {
+            agent_pair.second->write_state(writer);
+        }
+        vector<std::pair<string, Region>> watched;
+        for(const auto& object : objects) {
+            Region region;
+            if(subscriptions->watches.get_region(object->get_name(), region)) {
+                watched.push_back(make_pair(object->get_name(), region));
+            }
+        }
+        writer.put(static_cast<uint32_t>(watched.size()));
+        for(const auto& watch_pair : watched) {
+            writer.put_string(watch_pair.first);
+            writer.put(watch_pair.second.lower_left.x);
+            writer.put(watch_pair.second.lower_left.y);
+            writer.put(watch_pair.second.upper_right.x);
+            writer.put(watch_pair.second.upper_right.y);
+        }
+        writer.append(snapshot_end_c, 4);
+    }//the writer flushes the file as it goes out of scope
+    if(std::rename(temp_name.c_str(), filename.c_str()) != 0) {
+        throw Error{"Could not open output file!"};
+    }
+}
+//Only the objects and the watches are copied here, since that is all a
+//snapshot holds; the copy is written, and then destroyed, on the writer
+//thread, so this world never waits for either
+bool Model::start_snapshot(const string& filename, int tag)
+{
+    if(is_writing_snapshot()) {
+        return false;
+    }
+    finish_snapshot();
+    unique_ptr<Snapshot_job> job(new Snapshot_job);
+    job->world.reset(new Model(job->discard, time));
+    copy_objects(*job->world);
+    job->world->subscriptions->watches = subscriptions->watches;
+    for_each(job->world->objects.begin(), job->world->objects.end(),
+             mem_fn(&Sim_object::relink));
+    Snapshot_job* running = job.get();
+    job->writer = std::thread([running, filename, tag]() {
+        try {
+            running->world->write_snapshot(filename, tag);
+        }
+        catch(std::exception& error) {
+            running->error = error.what();
+        }
+        running->world.reset();
+        running->done = true;
+    });
+    snapshot_job = std::move(job);
+    return true;
+}
+//The job is kept until finish_snapshot is called, even once it is done
+bool Model::is_writing_snapshot() const
+{
+    return snapshot_job && !snapshot_job->done;
+}
+//The job is forgotten before any error is thrown, so it is only reported once
+void Model::finish_snapshot()
+{
+    if(!snapshot_job) {
+        return;
+    }
+    snapshot_job->writer.join();
+    string error = snapshot_job->error;
+    snapshot_job.reset();
+    if(!error.empty()) {
+        throw Error{error};
+    }
+}
+//Checks both ends of the file, then the header
+Binary_reader open_snapshot(const string& filename)
+{
+    Binary_reader reader(filename);
+    char magic[4];
+    if(reader.get_size() < sizeof(magic) * 2 ||
+       !reader.ends_with(snapshot_end_c, sizeof(magic))) {
+        throw Error{"Not a snapshot file!"};
+    }
+    reader.take(magic, sizeof(magic));
+    if(std::memcmp(magic, snapshot_magic_c, sizeof(magic)) != 0 ||
+       reader.get<uint16_t>() != snapshot_version_c) {
+        throw Error{"Not a snapshot file!"};
+    }
+    reader.skip_to(snapshot_alignment_c);
+    return reader;
+}
+//Every object in the file is created before anything in the world is
+//touched, so a file naming an unknown type leaves the world as it was.
+//Watches are put back last, since objects reporting in end the watches
+//of anyone near them.
+int Model::read_snapshot(const string& filename)
+{
+    Binary_reader reader = open_snapshot(filename);
+    int tag = reader.get<int32_t>();
+    int snapshot_time = reader.get<int32_t>();
+    uint32_t num_structures = reader.get<uint32_t>();
+    uint32_t num_agents = reader.get<uint32_t>();
+    auto read_entry = [&reader](string& type, string& name, Point& location) {
+        type = reader.get_string();
+        name = reader.get_string();
+        location.x = reader.get<double>();
+        location.y = reader.get<double>();
+    };
+    vector<shared_ptr<Structure>> new_structures;
+    vector<shared_ptr<Agent>> new_agents;
+    new_structures.reserve(num_structures);
+    new_agents.reserve(num_agents);
+    string type, name;
+    Point location;
+    for(uint32_t i = 0; i < num_structures; i++) {
+        read_entry(type, name, location);
+        new_structures.push_back(create_structure(name, type, location));
+    }
+    for(uint32_t i = 0; i < num_agents; i++) {
+        read_entry(type, name, location);
+        new_agents.push_back(create_agent(name, type, location));
+    }
+    stop_logistics();
+    checkpoints.clear();
+    hits.clear();
+    vector<string> old_names;
+    for(const auto& object : objects) {
+        old_names.push_back(object->get_name());
+    }
+    for(const string& old_name : old_names) {
+        remove_object(old_name);
+    }
+    invalidate_flow_fields();
+    time = snapshot_time;
+    epoch++;
+    insert_sorted(new_structures, structures);
+    insert_sorted(new_agents, agents);
+    for(auto& structure : new_structures) {
+        structure->read_state(reader);
+    }
+    for(auto& agent : new_agents) {
+        agent->read_state(reader);
+    }
+    broadcast_batch(new_structures);
+    broadcast_batch(new_agents);
+    uint32_t num_watches = reader.get<uint32_t>();
+    for(uint32_t i = 0; i < num_watches; i++) {
+        string watcher = reader.get_string();
+        Region region;
+        region.lower_left.x = reader.get<double>();
+        region.lower_left.y = reader.get<double>();
+        region.upper_right.x = reader.get<double>();
+        region.upper_right.y = reader.get<double>();
+        watch_region(watcher, region);
+    }
+    return tag;
+}
+//Only the header is looked at, but the whole file must be there
+int Model::read_snapshot_tag(const string& filename)
+{
+    Binary_reader reader = open_snapshot(filename);
+    return reader.get<int32_t>();
+}
+//Walks the location store, which only holds objects still in the world,
+//alongside the agents and structures to find each one's type; all three
+//are in name order, so no lookups are needed
+void Model::write_image(const string& filename, int width, int height) const
+{
+    vector<Image_point> points;
+    points.reserve(locations->size());
+    auto agent_iter = agents.begin();
+    auto struct_iter = structures.begin();
+    for(const auto& loc_pair : locations->get_all()) {
+        const string& name = loc_pair.first;
+        while(agent_iter != agents.end() && agent_iter->first < name) {
+            ++agent_iter;
+        }
+        while(struct_iter != structures.end() && struct_iter->first < name) {
+            ++struct_iter;
+        }
+        const char* type = nullptr;
+        if(agent_iter != agents.end() && agent_iter->first == name) {
+            type = agent_iter->second->get_type_name();
+        } else if(struct_iter != structures.end() &&
+                  struct_iter->first == name) {
+            type = struct_iter->second->get_type_name();
+        }
+        points.push_back(Image_point{loc_pair.second, type});
+    }
+    write_ppm_image(filename, width, height, points);
+}
+//Labels stay unique, so the older checkpoint just loses its label; it is
+//still needed to rewind to any earlier one
+void Model::checkpoint(const string& label)
+{
+    for(auto& older : checkpoints) {
+        if(older->label == label) {
+            older->label.clear();
+        }
+    }
+    checkpoints.emplace_back(new Checkpoint{label, time, {}, {}});
+    epoch++;
+}
+//An object's state at the checkpoint is the first copy saved of it from
+//then on; one whose name turns up first as added wasn't there yet. A name
+//can be saved and added in the same epoch if an agent died and its name
+//was reused, so the copies are looked at first. Everything is put back
+//before anything is relinked or reports in, since objects refer to each
+//other by pointer.
+void Model::rewind(const string& label)
+{
+    auto first = std::find_if(checkpoints.begin(), checkpoints.end(),
+                              [&label](const unique_ptr<Checkpoint>& older) {
+        return older->label == label;
+    });
+    if(first == checkpoints.end()) {
+        throw Error{"No checkpoint with that label!"};
+    }
+    map<string, const Checkpoint::Saved_state*> to_restore;
+    std::set<string> to_remove;
+    for(auto iter = first; iter != checkpoints.end(); ++iter) {
+        for(const auto& saved_pair : (*iter)->saved) {
+            if(!to_remove.count(saved_pair.first)) {
+                to_restore.insert(make_pair(saved_pair.first,
+                                            &saved_pair.second));
+            }
+        }
+        for(const string& name : (*iter)->added) {
+            if(!to_restore.count(name)) {
+                to_remove.insert(name);
+            }
+        }
+    }
+    stop_logistics();
+    for(const string& name : to_remove) {
+        remove_object(name);
+    }
+    for(const auto& restore_pair : to_restore) {
+        const Checkpoint::Saved_state& saved = *restore_pair.second;
+        shared_ptr<Agent> agent = dynamic_pointer_cast<Agent>(saved.object);
+        //noted first, since the copy's flag says it has been noted
+        saved.object->note_change();
+        saved.object->restore(*saved.state);
+        if(agent) {
+            auto agent_iter = agents.find(restore_pair.first);
+            if(agent_iter != agents.end() && agent_iter->second == agent) {
+                continue;
+            }
+            remove_object(restore_pair.first);//a newer agent of that name
+            insert_agent(agent);
+        }
+    }
+    if(!to_remove.empty()) {
+        invalidate_flow_fields();
+    }
+    time = (*first)->time;
+    checkpoints.erase(first + 1, checkpoints.end());
+    (*first)->saved.clear();
+    (*first)->added.clear();
+    epoch++;
+    for(const auto& restore_pair : to_restore) {
+        subscriptions->watches.remove(restore_pair.first);
+        restore_pair.second->object->relink();
+        restore_pair.second->object->broadcast_current_state();
+    }
+}
+//Agents are looked up first, since there are usually more of them. An
+//agent that has already died has nothing left to change.
+void Model::save_state(const string& name)
+{
+    if(checkpoints.empty()) {
+        return;
+    }
+    Checkpoint& latest = *checkpoints.back();
+    auto agent_iter = agents.find(name);
+    if(agent_iter != agents.end()) {
+        latest.saved.insert(make_pair(name, Checkpoint::Saved_state{
+            agent_iter->second, agent_iter->second->clone()}));
+        return;
+    }
+    auto struct_iter = structures.find(name);
+    if(struct_iter != structures.end()) {
+        latest.saved.insert(make_pair(name, Checkpoint::Saved_state{
+            struct_iter->second, struct_iter->second->clone()}));
+    }
+}
+//Nothing to note if there are no checkpoints to rewind to
+void Model::note_added(const string& name)
+{
+    if(!checkpoints.empty()) {
+        checkpoints.back()->added.insert(name);
+    }
+}
+//Structures only ever leave when rewound past; an agent may already have
+//died, in which case the views have heard it is gone
+void Model::remove_object(const string& name)
+{
+    auto agent_iter = agents.find(name);
+    if(agent_iter != agents.end()) {
+        remove_agent(agent_iter->second);
+        notify_gone(name);
+        return;
+    }
+    auto struct_iter = structures.find(name);
+    if(struct_iter != structures.end()) {
+        struct_iter->second->note_change();
+        objects.erase(struct_iter->second);
+        structures.erase(struct_iter);
+        notify_gone(name);
+    }
+}
+//The planner is only kept once it has made a plan
+void Model::start_logistics(const vector<shared_ptr<Agent>>& agents,
+                            const vector<shared_ptr<Structure>>& structures)
+{
+    unique_ptr<Logistics_planner> planner(
+        new Logistics_planner(agents, structures, output));
+    planner->plan();
+    logistics = std::move(planner);
+}
+//The Peasants are not stopped
+void Model::stop_logistics()
+{
+    logistics.reset();
 }
 
 //Removes the given agent from each container and deletes them.
 void Model::remove_agent(shared_ptr<Agent> agent)
 {
+    agent->note_change();
     agents.erase(agent->get_name());
     objects.erase(agent);
+    subscriptions->watches.remove(agent->get_name());
+    if(logistics) {
+        logistics->remove_peasant(agent->get_name());
+    }
 }
 
 //compares the two objects lexicographically by calling get_name
@@ -141,51 +1009,206 @@ bool Model::Less_than_obj_ptr::operator()(shared_ptr<Sim_object> p1,
     return p1->get_name() < p2->get_name();
 }
 
-//Inserts the view into the list of views
+//Inserts the view into the list of views and its subscriptions,
+//then hands only that view a snapshot of the current state
 void Model::attach(shared_ptr<View> view)
 {
+    prime_state();
     views.push_back(view);
+    subscribe(view);
+    view->sync(View_snapshot{locations->get_all(), healths, amounts});
+    //this way we ensure the view is "up to date"
+}
+//Has every object broadcast once, so the snapshot maps are complete.
+//After this, every change reaches them through the notify functions.
+void Model::prime_state()
+{
+    if(state_primed) return;
+    state_primed = true;
     for_each(objects.begin(), objects.end(),
              mem_fn(&Sim_object::broadcast_current_state));
-    //this way we ensure the view is "up to date"
 }
-//Removes the view from the list of views.
+//Removes the view from the list of views and its subscriptions.
 void Model::detach(shared_ptr<View> view)
 {
     views.remove(view);
+    unsubscribe(view);
 }
-//calls each view's update_location function to update the location of named obj
+//Asks the view what it wants to hear about, and files it accordingly
+void Model::subscribe(shared_ptr<View> view)
+{
+    int interests = view->get_interests();
+    Region region;
+    bool has_region = view->get_region(region);
+    if(interests & View::LOCATION_INTEREST) {
+        if(has_region)
+            subscriptions->region_location_views.insert(view, region);
+        else
+            subscriptions->location_views.push_back(view);
+    }
+    if(interests & View::GONE_INTEREST) {
+        if(has_region)
+            subscriptions->region_gone_views.insert(view, region);
+        else
+            subscriptions->gone_views.push_back(view);
+    }
+    if(interests & View::AMOUNT_INTEREST) {
+        subscriptions->amount_views.push_back(view);
+    }
+    if(interests & View::HEALTH_INTEREST) {
+        subscriptions->health_views.push_back(view);
+    }
+}
+//Removes the view from every list and index it could be in
+void Model::unsubscribe(shared_ptr<View> view)
+{
+    subscriptions->location_views.remove(view);
+    subscriptions->amount_views.remove(view);
+    subscriptions->health_views.remove(view);
+    subscriptions->gone_views.remove(view);
+    subscriptions->region_location_views.remove(view);
+    subscriptions->region_gone_views.remove(view);
+}
+//An update can move a view's region (a Local_view follows its object),
+//so after sending one we refile the view if its region changed.
+void Model::refresh_region(shared_ptr<View> view)
+{
+    Region new_region, old_region;
+    if(!view->get_region(new_region)) {
+        return;
+    }
+    if(subscriptions->region_location_views.get_region(view, old_region) &&
+       old_region != new_region) {
+        subscriptions->region_location_views.insert(view, new_region);
+    }
+    if(subscriptions->region_gone_views.get_region(view, old_region) &&
+       old_region != new_region) {
+        subscriptions->region_gone_views.insert(view, new_region);
+    }
+}
+//Starts, or restarts, the watch on the region
+void Model::watch_region(const string& watcher, const Region& region)
+{
+    subscriptions->watches.insert(watcher, region);
+}
+//The watch is gone once something has come into the region
+bool Model::is_watched(const string& watcher) const
+{
+    Region region;
+    return subscriptions->watches.get_region(watcher, region);
+}
+//Ends the watch of everyone but the object itself whose region the
+//location is in
+void Model::end_watches(const string& name, Point location)
+{
+    if(subscriptions->watches.empty()) return;
+    vector<string> watchers;
+    subscriptions->watches.find(location, watchers);
+    for(const string& watcher : watchers) {
+        if(watcher != name) {
+            subscriptions->watches.remove(watcher);
+        }
+    }
+}
+//Records the new location in the store, then calls update_location on
+//each view that wants locations everywhere, and on each region-limited
+//view whose region the object is entering, leaving or moving within.
 void Model::notify_location(const string &name, Point location)
 {
-    if(views.empty()) return;//do nothing if no views to update
-    for_each(views.begin(), views.end(),
+    Point old_location;
+    bool was_present = locations->get_location(name, old_location);
+    locations->update(name, location);
+    end_watches(name, location);
+    if(batch) {
+        batch->locations[name] = location;
+        return;
+    }
+    for_each(subscriptions->location_views.begin(),
+             subscriptions->location_views.end(),
              bind(&View::update_location, _1, name, location));
+    if(subscriptions->region_location_views.empty()) return;
+    vector<shared_ptr<View>> interested;
+    subscriptions->region_location_views.find(location, interested);
+    if(was_present) {
+        subscriptions->region_location_views.find(old_location, interested);
+    }
+    for(shared_ptr<View> view : interested) {
+        view->update_location(name, location);
+        refresh_region(view);
+    }
 }
-//Calls each view's update_amount function to update the amount of named obj
+//Records the amount for snapshots, and
+//calls update_amount on each view that wants amounts
 void Model::notify_amount(const string &name, double amount)
 {
-    if(views.empty()) return;
-    for_each(views.begin(), views.end(),
+    amounts[name] = amount;
+    if(batch) {
+        batch->amounts[name] = amount;
+        return;
+    }
+    for_each(subscriptions->amount_views.begin(),
+             subscriptions->amount_views.end(),
              bind(&View::update_amount, _1, name, amount));
 }
-//Calls each view's update_health function to update the health of named obj
+//Records the health for snapshots, and
+//calls update_health on each view that wants health
 void Model::notify_health(const string &name, double health)
 {
-    if(views.empty()) return;
-    for_each(views.begin(), views.end(),
+    healths[name] = health;
+    if(batch) {
+        batch->healths[name] = health;
+        return;
+    }
+    for_each(subscriptions->health_views.begin(),
+             subscriptions->health_views.end(),
              bind(&View::update_health, _1, name, health));
 }
-//calls each view's update_remove function to remove the named obj
+//Forgets the object's location, then calls update_remove on each view
+//that wants to know, including region-limited views the object was in
 void Model::notify_gone(const string &name)
 {
-    if(views.empty()) return;
-    for_each(views.begin(), views.end(), bind(&View::update_remove, _1, name));
+    Point old_location;
+    bool was_present = locations->get_location(name, old_location);
+    locations->remove(name);
+    healths.erase(name);
+    amounts.erase(name);
+    for_each(subscriptions->gone_views.begin(),
+             subscriptions->gone_views.end(),
+             bind(&View::update_remove, _1, name));
+    if(!was_present || subscriptions->region_gone_views.empty()) return;
+    vector<shared_ptr<View>> interested;
+    subscriptions->region_gone_views.find(old_location, interested);
+    for_each(interested.begin(), interested.end(),
+             bind(&View::update_remove, _1, name));
 }
-//calls each view's draw() function.
+//captures each view that is due and renders the frames right away, or if
+//there is a render thread, submits all of the frames as one batch.
+//Views that haven't changed only contribute a one-line marker.
 void Model::draw()
 {
     if(views.empty()) return;
-    for_each(views.begin(), views.end(), mem_fn(&View::draw));
+    vector<shared_ptr<const View_frame>> frames;
+    for(shared_ptr<View> view : views) {
+        shared_ptr<const View_frame> frame = view->capture_if_due(time);
+        if(frame) frames.push_back(frame);
+    }
+    if(!renderer) {
+        for(shared_ptr<const View_frame> frame : frames) {
+            frame->render(output);
+        }
+        return;
+    }
+    renderer->submit(std::move(frames));
+}
+//Creates or destroys the render thread; destroying it flushes its output
+void Model::set_async_drawing(bool async)
+{
+    if(async && !renderer) {
+        renderer.reset(new Renderer(output));
+    }
+    else if(!async) {
+        renderer.reset();
+    }
 }
 
 //returns true if a view of that name exists, false otherwise
@@ -208,39 +1231,30 @@ shared_ptr<View> Model::get_view(const string& name)
     return nullptr;//else we haven't found one!
 }
 //Returns the agent which is closest to the given agent
-//according to cartesian distance. 
+//according to cartesian distance, or nullptr if it is the only one.
+//Ties go to the first name, as they always have.
 shared_ptr<Agent> Model::get_closest_agent(shared_ptr<Agent> agent)
 {
-    return dynamic_pointer_cast<Agent>(get_closest_object(agent, agents));
-}
-//Takes in a map of objects and returns the object whose distance is closest
-//to the given agent
-template<typename T>
-shared_ptr<Sim_object> get_closest_object(shared_ptr<Agent> agent,
-                                          const T& obj_map)
-{
-    Point cur_loc = agent->get_location();
-    shared_ptr<Sim_object> candidate{nullptr};
-    double candidate_val{};
-    for(auto obj_iter = obj_map.begin(); obj_iter != obj_map.end();
-        obj_iter++) {
-        if(dynamic_pointer_cast<Agent>(obj_iter->second) == agent)
-            continue;//don't calculate distance to this very agent.
-        //if it isn't an agent, will compare to nullptr, and work as expected
-        double new_val = cartesian_distance(cur_loc,
-                                            obj_iter->second->get_location());
-        if(candidate == nullptr || new_val < candidate_val) {
-            candidate_val = new_val;
-            candidate = obj_iter->second;
-        }
+    Location_store::Located_object closest;
+    if(!locations->find_nearest(agent->get_location(),
+                                [this, &agent](const string& name) {
+        return name != agent->get_name() && is_agent_present(name);
+    }, closest)) {
+        return nullptr;
     }
-    return candidate;
+    return agents.find(closest.first)->second;
 }
 
 //Returns the structure which is closest to the given agent
-//according to cartesian distance.
+//according to cartesian distance, or nullptr if there are none.
 shared_ptr<Structure> Model::get_closest_structure(shared_ptr<Agent> agent)
 {
-    return dynamic_pointer_cast<Structure>(get_closest_object(agent,
-                                                              structures));
+    Location_store::Located_object closest;
+    if(!locations->find_nearest(agent->get_location(),
+                                [this](const string& name) {
+        return is_structure_present(name);
+    }, closest)) {
+        return nullptr;
+    }
+    return structures.find(closest.first)->second;
 }
@@ -7,6 +7,19 @@ It has facilities for looking up objects by name, and removing Agents.  When
 created, it creates an initial group of Structures and Agents using the Structure_factory
 and Agent_factory.
 Finally, it keeps the system's time.
+There can be any number of Models, each a separate world with its own objects,
+views and output; each object is bound to the Model it was added to. A world
+can be cloned, and the clones run on other threads, so what-if variants of
+one setup can run side by side.
+A world can also be checkpointed and rewound. A checkpoint copies nothing
+when it is taken; each object saves a copy of itself the first time it changes
+afterwards, so keeping many checkpoints only costs what actually changed.
+Model also keeps a hash of the whole state of the world, so two runs can be
+compared tick by tick. Each object's part of it is XORed into the total, and
+is only worked out again when the object has changed since.
+Finally, a world can be written to a snapshot file and read back in place of
+whatever is there. Snapshots can be written on a thread of their own, from a
+clone, so a long-running world can be saved often without waiting on the disk.
 
 Controller tells Model what to do; Model in turn tells the objects what do, and
 when asked to do so by an object, tells all the Views whenever anything changes that might be relevant.
@@ -18,29 +31,56 @@ Notice how only the Standard Library headers need to be included - reduced coupl
 #ifndef MODEL_H
 #define MODEL_H
 
+#include <string>
 #include <map>//for map of objects-to-names
+#include <unordered_map>//for each object's part of the state hash
 #include <set>//for overall set of objs
 #include <list>//for list of views
+#include <vector>//for bulk additions
 #include <memory>
+#include <functional>//posted tasks
+#include <iosfwd>//for output stream
+#include <cstdint>//for the state hash
 
 //forward declarations:
 class Agent;
 class Structure;
 class Sim_object;
 class View;
+class Location_store;
+class Renderer;
+class Trace_writer;
+class Logistics_planner;
+class Flow_field;
+class Task_queue;
+struct Region;
 struct Point;
  
 class Model {
 public:
-	// create the initial objects
+	// create the initial objects, with all messages going to cout
 	Model();
+	// create the initial objects, with all messages going to output_
+	explicit Model(std::ostream& output_);
+    //defined out of line, where Location_store is complete
+    ~Model();
     
-    //Returns the current instance of Model.
-    //If none exists, implicitly creates one.
-    static Model& get_instance();
+    // Returns a new world holding a copy of every object, at the same time
+    // and in the same state, with all messages going to output_. The copy
+    // has no views, traces, logistics plan or checkpoints, and tasks waiting
+    // here are not copied; it shares nothing with this world, so each may
+    // then be run on its own thread.
+    std::unique_ptr<Model> clone(std::ostream& output_) const;
 
 	// return the current time
-	int get_time() {return time;}
+	int get_time() const {return time;}
+	
+	// return where the objects and views of this world write their messages
+	std::ostream& get_output() const {return output;}
+
+	// returns the type name of the agent or structure with this name,
+	// or nullptr if there is none
+	const char* get_type_name(const std::string& name) const;
 
 	// is name already in use for either agent or structure?
     // return true if the name matches the name of an existing
@@ -51,6 +91,9 @@ public:
 	bool is_structure_present(const std::string& name) const;
 	// add a new structure; assumes none with the same name
 	void add_structure(std::shared_ptr<Structure> structure);
+    // add many new structures at once; assumes none share a name with each
+    // other or with any existing object
+    void add_structures(std::vector<std::shared_ptr<Structure>> new_structures);
 	// will throw Error("Structure not found!") if no structure of that name
 	std::shared_ptr<Structure>
         get_structure_ptr(const std::string& name) const;
@@ -59,18 +102,118 @@ public:
 	bool is_agent_present(const std::string& name) const;
 	// add a new agent; assumes none with the same name
 	void add_agent(std::shared_ptr<Agent> agent);
+    // add many new agents at once; assumes none share a name with each other
+    // or with any existing object
+    void add_agents(std::vector<std::shared_ptr<Agent>> new_agents);
 	// will throw Error("Agent not found!") if no agent of that name
 	std::shared_ptr<Agent>
         get_agent_ptr(const std::string& name) const;
+    // returns every agent, ordered by name
+    std::vector<std::shared_ptr<Agent>> get_all_agents() const;
+    // returns every structure, ordered by name
+    std::vector<std::shared_ptr<Structure>> get_all_structures() const;
 	
 	// tell all objects to describe themselves to the console
 	void describe() const;
-	// increment the time, and tell all objects to update themselves
+	// increment the time, tell all objects to update themselves, then
+	// resolve the hits they made
 	void update();	
 	
+	// record a hit on the target, to be taken once every object has updated
+	void queue_hit(std::shared_ptr<Agent> target,
+                   std::weak_ptr<Agent> attacker, int strength);
+	
+	// have the task done now, or if there is a task budget, after the
+	// objects update on this or some later tick; kind names the kind of work
+	void post_task(const std::string& kind, std::function<void()> task);
+	// set how many microseconds posted tasks may take each tick;
+	// 0 means tasks are done as soon as they are posted
+	void set_task_budget(int microseconds);
+	// return the task budget in microseconds, or 0 if there is none
+	int get_task_budget() const;
+	// output the task budget and how long each kind of task has waited
+	void describe_tasks() const;
+	
+	// Start writing the state of every object to the named file every
+	// interval ticks, replacing any trace already running.
+	// Throws Error("Could not open output file!") if the file can't be opened.
+	void start_trace(const std::string& filename, int interval);
+	// Stop tracing and close the file; no error if not tracing
+	void stop_trace();
+	
+	// Returns a hash of the state of every object and the time; worlds
+	// in the same state have the same hash
+	std::uint64_t get_state_hash();
+	// output the time and the state hash
+	void describe_state_hash();
+	// Output the state hash, and then do so again every interval ticks,
+	// replacing any hash trace already running
+	void start_hash_trace(int interval);
+	// Stop outputting the state hash; no error if not doing so
+	void stop_hash_trace();
+	// notes that the named object has been added, removed or is about to
+	// change, so its part of the state hash must be worked out again;
+	// objects call this through Sim_object::note_change
+	void note_changed(const std::string& name);
+	
+	// Write everything needed to put the world back the way it is now to
+	// the named file, with the tag saved alongside. The file is only
+	// replaced once the snapshot is complete.
+	// Throws Error("Could not open output file!") if it can't be written.
+	void write_snapshot(const std::string& filename, int tag) const;
+	// Clone the world, then have the copy write its snapshot on a thread of
+	// its own and return at once. Returns false without doing anything if
+	// the last snapshot started is still being written.
+	bool start_snapshot(const std::string& filename, int tag);
+	// returns true while a snapshot started is still being written
+	bool is_writing_snapshot() const;
+	// Wait for the snapshot being written, if there is one. Throws an Error
+	// saying why if it could not be written.
+	void finish_snapshot();
+	// Replace every object with those in the named snapshot and set the
+	// time back to when it was written; checkpoints and any logistics plan
+	// are discarded, and the views are told. Returns the snapshot's tag.
+	// Throws Error("Could not open input file!") if it can't be read, or
+	// Error("Not a snapshot file!") if it is not a complete snapshot.
+	int read_snapshot(const std::string& filename);
+	// returns the tag saved with the named snapshot; throws as read_snapshot
+	static int read_snapshot_tag(const std::string& filename);
+	
+	// Write an image of where every object is to the named file, width by
+	// height pixels, coloured by type.
+	// Throws Error("Image size must be positive!") if either is not, or
+	// Error("Could not open output file!") if the file can't be opened.
+	void write_image(const std::string& filename, int width, int height) const;
+	
+	// Marks the current state of the world with the label, replacing the
+	// label on any older checkpoint
+	void checkpoint(const std::string& label);
+	// Puts every object back the way it was at the checkpoint, brings back
+	// agents that have died and removes objects added since, and sets the
+	// time back. Later checkpoints are discarded, and any logistics plan is
+	// stopped; the checkpoint itself is kept, to be rewound to again.
+	// Throws Error("No checkpoint with that label!") if there isn't one.
+	void rewind(const std::string& label);
+	// returns the number of checkpoints taken or rewound to so far; an
+	// object changing for the first time since it last changed needs saving
+	int get_epoch() const {return epoch;}
+	// keeps a copy of the named object as it is now, to be restored if the
+	// latest checkpoint is rewound to; called by each object just before it
+	// first changes after a checkpoint
+	void save_state(const std::string& name);
+	
+	// Put the Peasants among agents to work between the Farms and Town_Halls
+	// among structures, and keep re-planning as structures are built and
+	// Peasants die, replacing any plan already running.
+	// Throws Error("No Peasants to plan for!") if there are no Peasants.
+	void start_logistics(const std::vector<std::shared_ptr<Agent>>& agents,
+                         const std::vector<std::shared_ptr<Structure>>& structures);
+	// Stop re-planning; the Peasants carry on with their last orders
+	void stop_logistics();
+	
 	/* View services */
-	// Attaching a View adds it to the container and causes it to be updated
-    // with all current objects'location (or other state information.
+	// Attaching a View adds it to the container and brings just that view
+    // up to date with a single snapshot of every object's state.
 	void attach(std::shared_ptr<View> view);
 	// Detach the View by discarding the supplied pointer from the container of Views
     // - no updates sent to it thereafter.
@@ -91,9 +234,26 @@ public:
     //exists
     std::shared_ptr<View> get_view(const std::string& name);
     
-    //calls each view's Draw function
+    //draws each view that has changed and whose refresh interval has
+    //passed, and a marker for each that hasn't changed; if drawing
+    //asynchronously, leaves the output to the render thread
     void draw();
     
+    //Starts or stops the render thread. Stopping it waits until everything
+    //already drawn has been written.
+    void set_async_drawing(bool async);
+    //returns true if views are being drawn on the render thread
+    bool is_drawing_async() const {return renderer != nullptr;}
+
+    //Returns the flow field leading to destination; everything headed to
+    //the same destination shares one field. Structures block movement.
+    std::shared_ptr<const Flow_field> get_flow_field(Point destination);
+
+    //Returns the store holding the location of every object in the world.
+    //Tile_views read from it instead of keeping copies of their own.
+    const Location_store& get_location_store() const
+        {return *locations;}
+    
     //Returns the agent which is closest to the provided agent
     //according to the cartesian distance.
     std::shared_ptr<Agent> get_closest_agent(
@@ -102,6 +262,14 @@ public:
     std::shared_ptr<Structure> get_closest_structure(
                                             std::shared_ptr<Agent> agent);
     
+    //Watches the region for any object other than watcher reporting a
+    //location inside it; the watch ends as soon as one does, or when the
+    //watcher is removed. Replaces any watch watcher already had.
+    void watch_region(const std::string& watcher, const Region& region);
+    //returns true if watcher's watch is still on: nothing else has come
+    //into its region since it started
+    bool is_watched(const std::string& watcher) const;
+    
 private:
     //function object to ensure objects are stored in correct order
     struct Less_than_obj_ptr {
@@ -110,17 +278,117 @@ private:
              std::shared_ptr<Sim_object> p2);
     };
     
+    std::ostream& output;
     std::map<std::string, std::shared_ptr<Agent>> agents;
     std::map<std::string, std::shared_ptr<Structure>> structures;
     std::set<std::shared_ptr<Sim_object>, Less_than_obj_ptr> objects;
     int time;
     std::list<std::shared_ptr<View>> views;
+    std::unique_ptr<Location_store> locations;
+    //latest health and amount reported for each object, kept for snapshots
+    std::map<std::string, double> healths;
+    std::map<std::string, double> amounts;
+    //true once every object has reported its state at least once
+    bool state_primed;
+    //the render thread, or nullptr if views are drawn synchronously
+    std::unique_ptr<Renderer> renderer;
+    //where periodic state dumps go, or nullptr if not tracing
+    std::unique_ptr<Trace_writer> trace;
+    int trace_interval;
+    //each object's part of the state hash, the XOR of all of them, and
+    //the names of objects whose part may be out of date
+    std::unordered_map<std::string, std::uint64_t> object_hashes;
+    std::uint64_t objects_hash;
+    std::vector<std::string> changed_names;
+    //false until the hash is asked for, and whenever changes aren't being
+    //noted; the next hash then works out every object's part
+    bool hash_tracking;
+    //how often the state hash is output, or 0 if it isn't
+    int hash_interval;
+    //hits made during this update, in the order they were made
+    struct Hit {
+        std::shared_ptr<Agent> target;
+        std::weak_ptr<Agent> attacker;
+        int strength;
+    };
+    std::vector<Hit> hits;
+    //decides who works where, or nullptr if Peasants are managed by hand
+    std::unique_ptr<Logistics_planner> logistics;
+    //true while a re-plan is waiting in the task queue
+    bool replan_posted;
+    //work that can wait for a later tick
+    std::unique_ptr<Task_queue> tasks;
+    //which views want to hear about which changes; defined in Model.cpp
+    struct Subscriptions;
+    std::unique_ptr<Subscriptions> subscriptions;
+    //while objects added together are reporting in, the state they report,
+    //to be handed to the views all at once; nullptr the rest of the time
+    struct Batch;
+    std::unique_ptr<Batch> batch;
+    //flow fields by destination, kept while something is using them;
+    //defined in Model.cpp
+    struct Flow_fields;
+    std::unique_ptr<Flow_fields> flow_fields;
+    //checkpoints, oldest first, each with the copies of the objects that
+    //changed while it was the latest; defined in Model.cpp
+    struct Checkpoint;
+    std::vector<std::unique_ptr<Checkpoint>> checkpoints;
+    int epoch;
+    //the clone being written by the snapshot thread, and the thread itself,
+    //or nullptr if no snapshot has been started since the last finished;
+    //defined in Model.cpp
+    struct Snapshot_job;
+    std::unique_ptr<Snapshot_job> snapshot_job;
+    
+    //creates an empty world at the given time
+    Model(std::ostream& output_, int time_);
     
-    //inserts a structure into the relevant containers
+    //inserts a structure into the relevant containers and binds it here
     void insert_structure(std::shared_ptr<Structure> structure);
     
-    //inserts an agent into the relevant containers
+    //inserts an agent into the relevant containers and binds it here
     void insert_agent(std::shared_ptr<Agent> agent);
+    
+    //notes that the object was added since the latest checkpoint, if any
+    void note_added(const std::string& name);
+    //takes the object out of every container and tells the views it is gone
+    void remove_object(const std::string& name);
+    
+    //inserts objects, sorted by name, into the name map and the object set,
+    //and the location store if update_locations is true; each goes in next
+    //to the one before, so runs of new names are cheap
+    template<typename T>
+    void insert_sorted(const std::vector<std::shared_ptr<T>>& sorted_objects,
+                       std::map<std::string, std::shared_ptr<T>>& name_map,
+                       bool update_locations = true);
+    //adds a copy of every object to world, which must have none; until
+    //they are relinked, the copies still refer to things in this world
+    void copy_objects(Model& world) const;
+    
+    //has each of the new objects broadcast its state, then gives each view
+    //a single snapshot of just those objects
+    template<typename T>
+    void broadcast_batch(const std::vector<std::shared_ptr<T>>& new_objects);
+    
+    //ends the watches of others whose region the location is in
+    void end_watches(const std::string& name, Point location);
+    //has each target take the sum of the hits on it at once, then tells
+    //the attackers of any target that died
+    void resolve_hits();
+    
+    //marks every flow field stale and forgets them, since the way to
+    //somewhere may have changed
+    void invalidate_flow_fields();
+    
+    //files the view under each kind of change it is interested in
+    void subscribe(std::shared_ptr<View> view);
+    //removes the view from every subscription
+    void unsubscribe(std::shared_ptr<View> view);
+    //refiles a region-limited view if its region has moved
+    void refresh_region(std::shared_ptr<View> view);
+    //the initial objects are created before anything can hear from them,
+    //so the first time a snapshot is needed they all report in
+    void prime_state();
 
 	// disallow copy/move construction or assignment
 	Model(const Model&) = delete;
@@ -1,4 +1,7 @@
 #include "Moving_object.h"
+#include "Flow_field.h"
+#include "Binary_writer.h"
+#include "Binary_reader.h"
 #include <cmath>
 
 using std::fabs;
@@ -8,8 +11,11 @@ using std::fabs;
 // If it is already at the destination and moving, it stops;
 // if already there and not moving, it stays stopped.
 // Otherwise, it starts moving, advancing by delta on each update call.
-void Moving_object::start_moving(Point destination_)
+void Moving_object::start_moving(Point destination_,
+								  std::shared_ptr<const Flow_field> field_)
 {
+	field = field_;
+	going_straight = false;
 	if(location == destination_) {
 		if(moving) {
 			stop_moving();
@@ -38,13 +44,59 @@ void Moving_object::stop_moving()
 	moving = false;
 	delta = Cartesian_vector();
 	destination = Point();
+	field = nullptr;
+	going_straight = false;
+}
+
+// the field is left to whoever owns this object, since fields belong to a world
+void Moving_object::write_state(Binary_writer& writer) const
+{
+	writer.put(static_cast<uint8_t>(moving));
+	writer.put(location.x);
+	writer.put(location.y);
+	writer.put(speed);
+	writer.put(destination.x);
+	writer.put(destination.y);
+	writer.put(delta.delta_x);
+	writer.put(delta.delta_y);
+}
+
+// read back in the same order; the field is left alone, and whether the way
+// is clear is found out again
+void Moving_object::read_state(Binary_reader& reader)
+{
+	going_straight = false;
+	moving = reader.get<uint8_t>() != 0;
+	location.x = reader.get<double>();
+	location.y = reader.get<double>();
+	speed = reader.get<double>();
+	destination.x = reader.get<double>();
+	destination.y = reader.get<double>();
+	delta.delta_x = reader.get<double>();
+	delta.delta_y = reader.get<double>();
 }
 
 // If the destination is within one delta step away, the object has arrived.
 // Set the location to the destination, stop, and return true.
 // Otherwise, add the delta to the location, and return false.
+// While an obstacle is in the way, the object follows the field instead, and
+// arrives once it is within one step of the destination; the delta is then
+// recomputed from wherever the field led, for going straight again. Once the
+// way is clear it stays clear, since the rest of a clear line is clear too.
 bool Moving_object::update_location()
 {
+	if(field && !going_straight && field->is_straight(location))
+		going_straight = true;
+	if(field && !going_straight) {
+		if(cartesian_distance(destination, location) <= speed) {
+			location = destination;
+			stop_moving();
+			return true;
+			}
+		location = field->advance(location, speed);
+		compute_delta();
+		return false;
+		}
 	Cartesian_vector diff = destination - location;
 	if ((fabs(diff.delta_x) <= fabs(delta.delta_x)) && (fabs(diff.delta_y) <= fabs(delta.delta_y))) {
 		location = destination;
@@ -1,16 +1,23 @@
 #ifndef MOVING_OBJECT
 #define MOVING_OBJECT
 #include "Geometry.h"
+#include <memory>
 /* Moving_object encapsulates the calculations needed to make an object move 
 from one point to another, moving a specified distance on each update_location call.
+If given a Flow_field, it follows the field instead of going in a straight line
+whenever an obstacle is in the way.
 */
 
+class Flow_field;
+class Binary_writer;
+class Binary_reader;
+
 class Moving_object {
 public:
 	Moving_object() :
-		moving(false) {}
+		moving(false), going_straight(false) {}
 	Moving_object(Point location_, double speed_) :
-		moving(false), location(location_), speed(speed_) {}
+		moving(false), location(location_), speed(speed_), going_straight(false) {}
 
 	// readers
 	bool is_currently_moving() const
@@ -21,16 +28,26 @@ public:
 		{return speed;}
 	Point get_current_destination() const
 		{return destination;}
+	std::shared_ptr<const Flow_field> get_current_field() const
+		{return field;}
 	
 	// Tell this object to start moving to location destination.
 	// If it is already at the destination and moving, it stops;
 	// if already there and not moving, it stays stopped.
-	// Otherwise, it starts moving, advancing by delta on each update call.
-	void start_moving(Point destination_);
+	// Otherwise, it starts moving, advancing by delta on each update call,
+	// or along field_, if it is given, while an obstacle is in the way.
+	void start_moving(Point destination_,
+					  std::shared_ptr<const Flow_field> field_ = nullptr);
+	// follow a different field to the same destination
+	void set_field(std::shared_ptr<const Flow_field> field_)
+		{field = field_; going_straight = false;}
 	// change the object's speed
 	void set_speed(double speed_);
 	// tell this object to stop moving
 	void stop_moving();
+	// write out or read back everything but the field, for a snapshot
+	void write_state(Binary_writer& writer) const;
+	void read_state(Binary_reader& reader);
 	// update this object's location using current location, speed, and destination
 	// returns true if arrived at destination, false if not
 	bool update_location();
@@ -41,6 +58,8 @@ private:
 	double speed;			// distance moved per update
 	Point destination;		// destination to move to
 	Cartesian_vector delta;	// x, y increments per update
+	std::shared_ptr<const Flow_field> field;	// shared way to the destination, if any
+	bool going_straight;	// true once nothing is in the way along delta
 	
 	// helpers
 	void compute_delta();
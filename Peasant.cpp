@@ -2,14 +2,16 @@
 #include "Structure.h"
 #include "Utility.h"
 #include "Model.h"
-#include <iostream>//cout, endl
+#include "State_hash.h"
+#include "Binary_writer.h"
+#include "Binary_reader.h"
+#include <ostream>//endl
 #include <cassert>//assert
 
 const double default_food_c = 0.0;
 const double max_food_c = 35.0;
 
 using std::string;
-using std::cout;
 using std::endl;
 using std::shared_ptr;
 
@@ -30,6 +32,7 @@ void Peasant::update()
     if(!is_alive() || working_state == Peasant_state_e::NOT_WORKING) {
         return;
     }
+    will_change();
     if(working_state == Peasant_state_e::INBOUND &&
        !is_moving() &&
        food_src->get_location() == get_location()) {
@@ -40,7 +43,7 @@ void Peasant::update()
         double received_amount=food_src->withdraw(max_food_c - food);
         food += received_amount;
         if(received_amount > 0.0) {//if it is positive
-            cout << get_name() << ": Collected " <<
+            get_output() << get_name() << ": Collected " <<
                 received_amount << endl;
             working_state = Peasant_state_e::OUTBOUND;
             Agent::move_to(food_dest->get_location());
@@ -48,7 +51,7 @@ void Peasant::update()
             //tell Model that food is changed
             return;
         }
-        cout << get_name() << ": Waiting " << endl;
+        get_output() << get_name() << ": Waiting " << endl;
         return;
     }
     if(working_state == Peasant_state_e::OUTBOUND &&
@@ -59,7 +62,7 @@ void Peasant::update()
     }
     if(working_state == Peasant_state_e::DEPOSITING) {
         food_dest->deposit(food);
-        cout << get_name() << ": Deposited " << food << endl;
+        get_output() << get_name() << ": Deposited " << food << endl;
         food = default_food_c;
         working_state = Peasant_state_e::INBOUND;
         Agent::move_to(food_src->get_location());
@@ -81,12 +84,13 @@ void Peasant::stop_work()
 {
     if(working_state != Peasant_state_e::NOT_WORKING) {
         end_work();
-        cout << get_name() << ": I'm stopping work" << endl;
+        get_output() << get_name() << ": I'm stopping work" << endl;
     }
 }
 //Sets food src and dest to null, ensures the peasant isn't working
 void Peasant::end_work()
 {
+    will_change();
     food_src = nullptr;
     food_dest = nullptr;
     working_state = Peasant_state_e::NOT_WORKING;
@@ -134,26 +138,26 @@ void Peasant::start_working(shared_ptr<Structure> source_,
 //or collecting/depositing food
 void Peasant::describe() const
 {
-    cout << "Peasant ";
+    get_output() << "Peasant ";
     Agent::describe();
-    cout << "   Carrying " << food << endl;
+    get_output() << "   Carrying " << food << endl;
     switch(working_state) {
         case Peasant_state_e::NOT_WORKING:
             break;//do nothing
         case Peasant_state_e::OUTBOUND:
-            cout << "   Outbound to destination " <<
+            get_output() << "   Outbound to destination " <<
             food_dest->get_name() << endl;
             break;
         case Peasant_state_e::INBOUND:
-            cout << "   Inbound to source " <<
+            get_output() << "   Inbound to source " <<
             food_src->get_name() << endl;
             break;
         case Peasant_state_e::COLLECTING:
-            cout << "   Collecting at source " <<
+            get_output() << "   Collecting at source " <<
             food_src->get_name() << endl;
             break;
         case Peasant_state_e::DEPOSITING:
-            cout << "   Depositing at destination " <<
+            get_output() << "   Depositing at destination " <<
             food_dest->get_name() << endl;
             break;
         default:
@@ -167,10 +171,59 @@ void Peasant::describe() const
     }
     
 }
+//Structures are mixed in by name, since each world has its own
+void Peasant::hash_state(State_hash& hash) const
+{
+    Agent::hash_state(hash);
+    hash.add(static_cast<int>(working_state));
+    hash.add(food);
+    hash.add(food_src ? food_src->get_name() : string());
+    hash.add(food_dest ? food_dest->get_name() : string());
+}
+//An empty name means no structure
+void Peasant::write_state(Binary_writer& writer) const
+{
+    Agent::write_state(writer);
+    writer.put(static_cast<int32_t>(working_state));
+    writer.put(food);
+    writer.put_string(food_src ? food_src->get_name() : string());
+    writer.put_string(food_dest ? food_dest->get_name() : string());
+}
+//The structures have already been added to the world
+void Peasant::read_state(Binary_reader& reader)
+{
+    Agent::read_state(reader);
+    working_state = static_cast<Peasant_state_e>(reader.get<int32_t>());
+    food = reader.get<double>();
+    string src_name = reader.get_string();
+    string dest_name = reader.get_string();
+    food_src = src_name.empty() ? nullptr :
+        get_model().get_structure_ptr(src_name);
+    food_dest = dest_name.empty() ? nullptr :
+        get_model().get_structure_ptr(dest_name);
+}
+
+//Structures are never removed, so the new world has both of them
+void Peasant::relink()
+{
+    Agent::relink();
+    if(food_src) {
+        food_src = get_model().get_structure_ptr(food_src->get_name());
+    }
+    if(food_dest) {
+        food_dest = get_model().get_structure_ptr(food_dest->get_name());
+    }
+}
+
+//All Peasants carry the same amount
+double Peasant::get_capacity()
+{
+    return max_food_c;
+}
 
 //Notify Model about the amount carried as well as health
 void Peasant::broadcast_current_state()
 {
     Agent::broadcast_current_state();
-    Model::get_instance().notify_amount(get_name(), food);
+    get_model().notify_amount(get_name(), food);
 }
@@ -17,7 +17,18 @@ class Peasant : public Agent {
 
 public:
     
+    //the name this type is created by
+    static constexpr const char* type_name() {return "Peasant";}
+    const char* get_type_name() const override {return type_name();}
+
 	Peasant(const std::string& name_, Point location_);
+    std::shared_ptr<Agent> clone() const override
+        {return std::make_shared<Peasant>(*this);}
+    void restore(const Sim_object& saved) override
+        {*this = static_cast<const Peasant&>(saved);}
+    
+    // works between the structures of the same names in the new world
+    void relink() override;
 
 	// implement Peasant behavior
 	void update() override;
@@ -35,9 +46,18 @@ public:
 
 	// output information about the current state
 	void describe() const override;
+	// mixes in the working state, the food carried and where it works
+	void hash_state(State_hash& hash) const override;
+	// also writes or reads back the working state, the food carried and
+	// the names of the structures worked between
+	void write_state(Binary_writer& writer) const override;
+	void read_state(Binary_reader& reader) override;
     //notify Model about the amount carried 
     void broadcast_current_state() override;
     
+    //returns the most food a Peasant can carry at once
+    static double get_capacity();
+    
 private:
     enum class Peasant_state_e {
         NOT_WORKING,
@@ -0,0 +1,134 @@
+/*
+Pool_allocator hands out memory from one big block reserved up front, so
+creating many objects of the same kind costs one allocation instead of one
+each. It is meant for std::allocate_shared: every shared_ptr made with a
+copy of the allocator keeps the block alive, and the block is released
+when the last of them is gone. Requests that don't fit in the block fall
+back to the ordinary operator new.
+
+Memory in a block is never reused: destroying an object does not give its
+room back, and the block is only released as a whole. So a single object
+that outlives the rest of its batch keeps the memory of the entire batch.
+
+How much room allocate_shared needs for each object, its own bookkeeping
+and a copy of the allocator included, is up to the library;
+shared_allocation_size asks it, using an allocator with no block, which
+reports the size it is asked for instead of handing out memory.
+*/
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <memory>
+#include <new>//operator new, bad_alloc
+#include <cstddef>//size_t
+#include <utility>//forward
+
+//One block of memory, handed out front to back and never reused
+class Pool_block {
+public:
+    //Reserves capacity_ bytes
+    Pool_block(std::size_t capacity_) :
+    memory(static_cast<char*>(::operator new(capacity_))),
+    capacity(capacity_), used(0)
+    {}
+    ~Pool_block() {::operator delete(memory);}
+
+    //Returns aligned memory from the block, or nullptr if it is used up
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        std::size_t start = (used + alignment - 1) / alignment * alignment;
+        if(start + size > capacity) {
+            return nullptr;
+        }
+        used = start + size;
+        return memory + start;
+    }
+
+    //returns true if the pointer came from this block
+    bool owns(const void* ptr) const
+    {
+        const char* byte_ptr = static_cast<const char*>(ptr);
+        return byte_ptr >= memory && byte_ptr < memory + capacity;
+    }
+
+private:
+    char* memory;
+    std::size_t capacity;
+    std::size_t used;
+
+	// disallow copy/move construction or assignment
+	Pool_block(const Pool_block&) = delete;
+	Pool_block& operator= (const Pool_block&)  = delete;
+};
+
+//What an allocator with no block was asked for; thrown rather than
+//returned so that nothing is constructed
+struct Allocation_size {
+    std::size_t size;
+    std::size_t alignment;
+};
+
+template<typename T>
+class Pool_allocator {
+public:
+    typedef T value_type;
+
+    //Shares the given block
+    Pool_allocator(std::shared_ptr<Pool_block> block_) : block(block_) {}
+    //Has no block, and only reports what it is asked for
+    Pool_allocator() {}
+    //Allocators for other types share the same block
+    template<typename U>
+    Pool_allocator(const Pool_allocator<U>& other) : block(other.block) {}
+
+    //Takes memory from the block if there is room, from the heap if not;
+    //with no block, throws the size and alignment of the request
+    T* allocate(std::size_t n)
+    {
+        if(!block) {
+            throw Allocation_size{n * sizeof(T), alignof(T)};
+        }
+        void* ptr = block->allocate(n * sizeof(T), alignof(T));
+        if(!ptr) {
+            ptr = ::operator new(n * sizeof(T));
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    //Memory from the block is given back all at once when the block goes
+    void deallocate(T* ptr, std::size_t n)
+    {
+        if(block && !block->owns(ptr)) {
+            ::operator delete(ptr);
+        }
+    }
+
+    template<typename U>
+    bool operator== (const Pool_allocator<U>& rhs) const
+        {return block == rhs.block;}
+    template<typename U>
+    bool operator!= (const Pool_allocator<U>& rhs) const
+        {return block != rhs.block;}
+
+private:
+    template<typename U> friend class Pool_allocator;
+    std::shared_ptr<Pool_block> block;
+};
+
+//Returns how much memory std::allocate_shared<T> takes in one allocation
+//from a Pool_allocator, for T and its bookkeeping together. The arguments
+//are only used to pick the constructor; no T is made.
+template<typename T, typename... Args>
+Allocation_size shared_allocation_size(Args&&... args)
+{
+    try {
+        std::allocate_shared<T>(Pool_allocator<T>(),
+                                std::forward<Args>(args)...);
+    }
+    catch(Allocation_size& requested) {
+        return requested;
+    }
+    return Allocation_size{0, 1};//allocate_shared never allocates
+}
+
+#endif
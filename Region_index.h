@@ -0,0 +1,168 @@
+/*
+Region_index keeps track of items that are each interested in one rectangular
+Region of the world, and answers "which items care about this location?"
+without asking every item. Each item is filed under every grid cell its region
+overlaps; an item whose region is too big to file that way is kept aside and
+always checked.
+*/
+#ifndef REGION_INDEX_H
+#define REGION_INDEX_H
+
+#include "Spatial_grid.h"//Region, grid cells
+#include <map>//item-to-region map
+#include <unordered_map>//cells of the grid
+#include <vector>//items in a cell, query results
+#include <algorithm>//find, remove
+#include <functional>//less
+
+//regions covering more cells than this are not filed cell by cell
+const long long max_indexed_cells_c = 64;
+
+template<typename T, typename Compare = std::less<T>>
+class Region_index {
+public:
+    //Creates an empty index whose grid cells are cell_size_ units across
+    Region_index(double cell_size_) : cell_size(cell_size_) {}
+
+    //Files the item under the given region, replacing any previous one
+    void insert(const T& item, const Region& region);
+
+    //Forgets the item; no error if it is not present
+    void remove(const T& item);
+
+    //If the item is present, sets region to its region and returns true;
+    //returns false otherwise.
+    bool get_region(const T& item, Region& region) const;
+
+    //Appends every item whose region contains the location to result,
+    //unless it is already there.
+    void find(Point location, std::vector<T>& result) const;
+
+    //returns true if no items are filed
+    bool empty() const {return regions.empty();}
+
+private:
+    double cell_size;
+    std::map<T, Region, Compare> regions;
+    std::unordered_map<Grid_key, std::vector<T>> cells;
+    std::vector<T> oversized;
+
+    //calls fcn with the key of every cell the region overlaps,
+    //or returns false without doing so if there are too many of them
+    template<typename F>
+    bool for_each_cell(const Region& region, F fcn) const;
+    //appends item to result if it is not already there
+    void add_unique(const T& item, std::vector<T>& result) const;
+};
+
+//Removes the item from wherever it was filed, then files it again
+template<typename T, typename Compare>
+void Region_index<T, Compare>::insert(const T& item, const Region& region)
+{
+    remove(item);
+    regions.insert(std::make_pair(item, region));
+    if(!for_each_cell(region, [this, &item](Grid_key key) {
+        cells[key].push_back(item);
+    })) {
+        oversized.push_back(item);
+    }
+}
+
+//Takes the item out of each cell its region overlaps
+template<typename T, typename Compare>
+void Region_index<T, Compare>::remove(const T& item)
+{
+    auto region_iter = regions.find(item);
+    if(region_iter == regions.end()) {
+        return;
+    }
+    Compare less;
+    auto same_item = [&item, &less](const T& other) {
+        return !less(item, other) && !less(other, item);
+    };
+    if(!for_each_cell(region_iter->second,
+                      [this, &same_item](Grid_key key) {
+        auto cell_iter = cells.find(key);
+        std::vector<T>& items = cell_iter->second;
+        items.erase(std::remove_if(items.begin(), items.end(), same_item),
+                    items.end());
+        if(items.empty()) {
+            cells.erase(cell_iter);
+        }
+    })) {
+        oversized.erase(std::remove_if(oversized.begin(), oversized.end(),
+                                       same_item), oversized.end());
+    }
+    regions.erase(region_iter);
+}
+
+//Looks up the region the item was filed under
+template<typename T, typename Compare>
+bool Region_index<T, Compare>::get_region(const T& item, Region& region) const
+{
+    auto region_iter = regions.find(item);
+    if(region_iter == regions.end()) {
+        return false;
+    }
+    region = region_iter->second;
+    return true;
+}
+
+//Checks the items filed in the location's cell, and the oversized ones
+template<typename T, typename Compare>
+void Region_index<T, Compare>::find(Point location,
+                                    std::vector<T>& result) const
+{
+    auto cell_iter = cells.find(get_grid_key(location, cell_size));
+    if(cell_iter != cells.end()) {
+        for(const T& item : cell_iter->second) {
+            if(regions.find(item)->second.contains(location)) {
+                add_unique(item, result);
+            }
+        }
+    }
+    for(const T& item : oversized) {
+        if(regions.find(item)->second.contains(location)) {
+            add_unique(item, result);
+        }
+    }
+}
+
+//Visits the key of every cell between the region's corners
+template<typename T, typename Compare>
+template<typename F>
+bool Region_index<T, Compare>::for_each_cell(const Region& region,
+                                             F fcn) const
+{
+    long long lo_x, lo_y, hi_x, hi_y;
+    get_grid_coords(region.lower_left, cell_size, lo_x, lo_y);
+    get_grid_coords(region.upper_right, cell_size, hi_x, hi_y);
+    if(hi_x < lo_x || hi_y < lo_y ||
+       hi_x - lo_x >= max_indexed_cells_c ||
+       hi_y - lo_y >= max_indexed_cells_c ||
+       (hi_x - lo_x + 1) * (hi_y - lo_y + 1) > max_indexed_cells_c) {
+        return false;
+    }
+    for(long long cx = lo_x; cx <= hi_x; cx++) {
+        for(long long cy = lo_y; cy <= hi_y; cy++) {
+            fcn(make_grid_key(cx, cy));
+        }
+    }
+    return true;
+}
+
+//Items are only ever reported once per query
+template<typename T, typename Compare>
+void Region_index<T, Compare>::add_unique(const T& item,
+                                          std::vector<T>& result) const
+{
+    Compare less;
+    for(const T& other : result) {
+        if(!less(item, other) && !less(other, item)) {
+            return;
+        }
+    }
+    result.push_back(item);
+}
+
+#endif
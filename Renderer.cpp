@@ -0,0 +1,139 @@
+#include "Renderer.h"
+#include "View.h"
+#include <sstream>//formatting off to the side
+#include <chrono>//idle wait
+
+using std::vector;
+using std::shared_ptr;
+using std::ostream;
+using std::ostringstream;
+using std::string;
+
+//how long the render thread naps when there is nothing to write
+const std::chrono::milliseconds render_idle_wait_c(1);
+
+//Remembers how the stream is formatted now and writes through a stream of
+//its own, since the simulation thread may change the original's format
+//while the render thread is writing
+Renderer::Renderer(ostream& os_) :
+source(os_), target(os_.rdbuf()), capture(*this), os(target),
+flags(os_.flags()), precision(os_.precision()),
+back_buffer(nullptr), stopping(false)
+{
+    worker = std::thread(&Renderer::run, this);
+    source.rdbuf(&capture);
+}
+
+//Hands over the last of the captured text, waits for the render thread to
+//write everything, then lets the caller write directly again
+Renderer::~Renderer()
+{
+    push(capture.take(), {});
+    stopping = true;
+    worker.join();
+    if(source.rdbuf() == &capture) {
+        source.rdbuf(target);
+    }
+}
+
+//A muted stream has been pointed elsewhere; what it would have drawn goes
+//there too, as it would with no render thread
+void Renderer::submit(vector<shared_ptr<const View_frame>> frames)
+{
+    if(source.rdbuf() != &capture) {
+        for(const auto& frame : frames) {
+            frame->render(source);
+        }
+        return;
+    }
+    push(capture.take(), std::move(frames));
+}
+
+//Pushes a new batch onto the back buffer, unless there is nothing in it
+void Renderer::push(string text, vector<shared_ptr<const View_frame>> frames)
+{
+    if(text.empty() && frames.empty()) {
+        return;
+    }
+    Batch* batch = new Batch{std::move(text), std::move(frames),
+        back_buffer.load()};
+    while(!back_buffer.compare_exchange_weak(batch->next, batch))
+        ;//batch->next has been reloaded; try again
+}
+
+//Keeps writing until stopping is set and the back buffer is empty
+void Renderer::run()
+{
+    while(true) {
+        if(render_pending()) {
+            continue;
+        }
+        if(stopping) {
+            render_pending();//anything submitted since we last looked
+            return;
+        }
+        std::this_thread::sleep_for(render_idle_wait_c);
+    }
+}
+
+//Takes the whole back buffer, restores submission order, formats every
+//batch's text and frames into one buffer and writes that in one go
+bool Renderer::render_pending()
+{
+    Batch* newest = back_buffer.exchange(nullptr);
+    if(!newest) {
+        return false;
+    }
+    Batch* oldest = nullptr;
+    while(newest) {//reverse the list
+        Batch* next = newest->next;
+        newest->next = oldest;
+        oldest = newest;
+        newest = next;
+    }
+    ostringstream buffer;
+    buffer.flags(flags);
+    buffer.precision(precision);
+    while(oldest) {
+        buffer << oldest->text;
+        for(const auto& frame : oldest->frames) {
+            frame->render(buffer);
+        }
+        Batch* done = oldest;
+        oldest = oldest->next;
+        delete done;
+    }
+    string text = buffer.str();
+    os.write(text.data(), text.size());
+    os.flush();
+    return true;
+}
+
+string Renderer::Capture_buffer::take()
+{
+    string taken;
+    taken.swap(text);
+    return taken;
+}
+
+int Renderer::Capture_buffer::overflow(int c)
+{
+    if(!traits_type::eq_int_type(c, traits_type::eof())) {
+        text += traits_type::to_char_type(c);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize Renderer::Capture_buffer::xsputn(const char* s,
+    std::streamsize n)
+{
+    text.append(s, static_cast<string::size_type>(n));
+    return n;
+}
+
+//A flush, from endl or before input is read, sends the text on its way
+int Renderer::Capture_buffer::sync()
+{
+    renderer.push(take(), {});
+    return 0;
+}
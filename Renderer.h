@@ -0,0 +1,97 @@
+/*
+Renderer formats and writes captured View_frames on a thread of its own, so
+the simulation never has to wait on the terminal. When asked to draw, Model
+captures every view on the simulation thread and submits the frames as one
+batch; the render thread formats and writes them while the next tick runs.
+
+Hand-off is lock-free and double-buffered: the simulation thread pushes
+batches onto the back buffer with an atomic compare-and-swap, and the render
+thread swaps the whole back buffer out in one atomic exchange and writes it
+as its front buffer. Frames are immutable, so neither side ever waits for
+the other.
+
+While it runs, the render thread is the only writer to the caller's stream
+buffer. Everything else written to the caller's stream is captured on the
+simulation thread and submitted as text each time the stream is flushed, so
+it comes out in order with the frames around it.
+*/
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+class View_frame;
+
+class Renderer {
+public:
+    //Starts the render thread, which writes to os's buffer using the format
+    //flags os has right now, and points os at a buffer that hands what is
+    //written to it over to the render thread
+    Renderer(std::ostream& os_);
+    //Writes whatever is still pending, stops the render thread and gives os
+    //its own buffer back
+    ~Renderer();
+
+    //Hands the frames, after any text written before them, to the render
+    //thread; returns immediately. If the stream has been redirected since,
+    //the frames are rendered into it right away instead.
+    void submit(std::vector<std::shared_ptr<const View_frame>> frames);
+
+private:
+    //One call to submit's worth of text and frames, linked newest first
+    struct Batch {
+        std::string text;
+        std::vector<std::shared_ptr<const View_frame>> frames;
+        Batch* next;
+    };
+
+    //Collects what the simulation thread writes to the caller's stream,
+    //and submits it whenever the stream is flushed
+    class Capture_buffer : public std::streambuf {
+    public:
+        Capture_buffer(Renderer& renderer_) : renderer(renderer_) {}
+        //takes the text collected so far
+        std::string take();
+    protected:
+        int overflow(int c) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+        int sync() override;
+    private:
+        Renderer& renderer;
+        std::string text;
+    };
+
+    std::ostream& source;//the caller's stream, pointed at capture
+    std::streambuf* target;//the caller's own buffer
+    Capture_buffer capture;
+    std::ostream os;//writes to target
+    std::ios::fmtflags flags;
+    std::streamsize precision;
+    std::atomic<Batch*> back_buffer;
+    std::atomic<bool> stopping;
+    std::thread worker;
+
+    //Pushes a batch onto the back buffer
+    void push(std::string text,
+        std::vector<std::shared_ptr<const View_frame>> frames);
+    //Renders batches as they arrive until told to stop
+    void run();
+    //Swaps out the back buffer and writes it, oldest batch first and each
+    //batch's text before its frames, in a single write. Returns false if
+    //there was nothing to write.
+    bool render_pending();
+
+	// disallow copy/move construction or assignment
+	Renderer(const Renderer&) = delete;
+	Renderer& operator= (const Renderer&)  = delete;
+	Renderer(Renderer&&) = delete;
+	Renderer& operator= (Renderer&&) = delete;
+};
+
+#endif
@@ -1,12 +1,59 @@
 #include "Sim_object.h"
+#include "Model.h"
+#include "State_hash.h"
 #include <string>
 using std::string;
 
-//sets the name to the name given
-Sim_object::Sim_object(const string& name_) : name(name_)
+//sets the name to the name given; no world until Model binds it
+Sim_object::Sim_object(const string& name_) :
+name(name_), model(nullptr), saved_epoch(0), hash_stale(false)
 {
 }
 
+//Nothing has changed since the world's latest checkpoint as far as the
+//new world is concerned, but the object is new to the world's hash
+void Sim_object::set_model(Model* model_)
+{
+    model = model_;
+    saved_epoch = model->get_epoch();
+    note_change();
+}
+
+//Asks the world this object belongs to
+int Sim_object::current_epoch() const
+{
+    return model->get_epoch();
+}
+
+//Noted first, so the copy agrees it has been saved
+void Sim_object::save_state()
+{
+    saved_epoch = model->get_epoch();
+    model->save_state(get_name());
+}
+
+//Flagged first, so later changes don't tell Model again
+void Sim_object::note_change()
+{
+    if(hash_stale) {
+        return;
+    }
+    hash_stale = true;
+    model->note_changed(get_name());
+}
+
+//Every object's state starts with its name
+void Sim_object::hash_state(State_hash& hash) const
+{
+    hash.add(get_name());
+}
+
+//Asks the world this object belongs to
+std::ostream& Sim_object::get_output() const
+{
+    return model->get_output();
+}
+
 Sim_object::~Sim_object()
 {
 }
@@ -1,12 +1,28 @@
 /* The Sim_object class provides the interface for all of simulation objects. 
 It also stores the object's name, and has pure virtual accessor functions for 
-the object's position and other information. */
+the object's position and other information.
+Each object belongs to one world: the Model it was added to binds it, and the
+object reports to that Model and writes its messages to that Model's output,
+so several worlds can run side by side.
+Objects help Model keep checkpoints: just before an object first changes after
+a checkpoint, it has Model keep a copy of its state, so a checkpoint only
+costs a copy of each object that has changed since.
+The same calls keep the world's state hash up to date: an object that is
+about to change tells Model once, and Model works its part of the hash out
+again only when the hash is next asked for.
+For snapshots, each kind of object writes out whatever it needs to be put
+back the way it is, and reads it back into a newly created object. */
 #ifndef SIM_OBJECT_H
 #define SIM_OBJECT_H
 
 #include <string>
+#include <iosfwd>//ostream
 
 struct Point;//incomplete fwd declaration
+class Model;
+class State_hash;
+class Binary_writer;
+class Binary_reader;
 
 class Sim_object {
 public:
@@ -21,11 +37,65 @@ public:
     virtual void broadcast_current_state() {}
     
     virtual Point get_location() const = 0;
+    // return the name of this object's type, as given to the factory
+    virtual const char* get_type_name() const = 0;
     virtual void describe() const {}
     virtual void update() {}
+    
+    // binds this object to the world it belongs to; Model does this when
+    // the object is added, and the object counts as already saved for the
+    // world's latest checkpoint, since it wasn't there when it was taken
+    void set_model(Model* model_);
+    // after being copied into another world, replaces whatever this object
+    // refers to with the same thing in the world it is bound to now;
+    // does nothing by default
+    virtual void relink() {}
+    // puts this object back in the state saved, a copy of an object of the
+    // same type
+    virtual void restore(const Sim_object& saved) = 0;
+    // mixes everything that makes up this object's state into hash;
+    // the base mixes in just the name
+    virtual void hash_state(State_hash& hash) const;
+    // called by Model once this object's part of the world's hash has been
+    // worked out again; the next change tells Model about it
+    void set_hash_current() {hash_stale = false;}
+    // tells Model this object's part of the hash needs working out again,
+    // unless it has been told so since the part was last worked out; Model
+    // calls this when it adds, removes or restores the object
+    void note_change();
+    // writes everything a snapshot needs to put this object back the way
+    // it is, besides its type, name and location; nothing by default
+    virtual void write_state(Binary_writer& writer) const {}
+    // reads back what write_state wrote, into an object just created with
+    // the same type, name and location; every other object in the
+    // snapshot has already been added to this object's world
+    virtual void read_state(Binary_reader& reader) {}
+
+protected:
+    // the world this object belongs to
+    Model& get_model() const {return *model;}
+    // where this object's messages go: its world's output
+    std::ostream& get_output() const;
+    // must be called just before changing any state a checkpoint restores
+    // or the state hash covers; the first change after each checkpoint has
+    // Model save a copy, and the first since the hash was worked out tells
+    // Model the hash needs this object's part again
+    void will_change()
+    {
+        if(!hash_stale) note_change();
+        if(saved_epoch != current_epoch()) save_state();
+    }
 
 private:
 	std::string name;
+    Model* model;
+    int saved_epoch;//the checkpoint epoch in which a copy was last saved
+    bool hash_stale;//true if Model has been told this object has changed
+    
+    //returns the world's checkpoint epoch
+    int current_epoch() const;
+    //has Model keep a copy of this object as it is now
+    void save_state();
 };
 
 #endif
@@ -0,0 +1,47 @@
+#include "Spatial_grid.h"
+#include <cmath>//floor
+
+using std::floor;
+
+//Returns true if the point lies within the lower-left inclusive,
+//upper-right exclusive bounds of the region
+bool Region::contains(Point location) const
+{
+    return location.x >= lower_left.x && location.x < upper_right.x &&
+        location.y >= lower_left.y && location.y < upper_right.y;
+}
+
+//Regions are equal if both of their corners are
+bool Region::operator== (const Region& rhs) const
+{
+    return lower_left == rhs.lower_left && upper_right == rhs.upper_right;
+}
+
+bool Region::operator!= (const Region& rhs) const
+{
+    return !(*this == rhs);
+}
+
+//Computes the grid coordinates of the cell containing the location
+void get_grid_coords(Point location, double cell_size,
+                     long long& cx, long long& cy)
+{
+    cx = static_cast<long long>(floor(location.x / cell_size));
+    cy = static_cast<long long>(floor(location.y / cell_size));
+}
+
+//Packs the low 32 bits of each coordinate into one key
+Grid_key make_grid_key(long long cx, long long cy)
+{
+    return static_cast<Grid_key>((static_cast<unsigned long long>(cx) << 32) ^
+                                 (static_cast<unsigned long long>(cy) &
+                                  0xffffffffULL));
+}
+
+//Returns the key of the cell containing the location
+Grid_key get_grid_key(Point location, double cell_size)
+{
+    long long cx, cy;
+    get_grid_coords(location, cell_size, cx, cy);
+    return make_grid_key(cx, cy);
+}
@@ -0,0 +1,43 @@
+/*
+Spatial_grid holds the pieces shared by everything that buckets the world
+into square grid cells: the Region type used to describe a rectangle of the
+world, and the functions that find which cell a location falls in.
+*/
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "Geometry.h"//Point
+
+//An axis-aligned rectangle in world coordinates. The lower and left edges
+//are part of the region, the upper and right edges are not.
+struct Region {
+    Point lower_left;
+    Point upper_right;
+
+    Region(Point lower_left_ = Point(), Point upper_right_ = Point()) :
+    lower_left(lower_left_), upper_right(upper_right_)
+    {}
+
+    //returns true if the point lies within the region
+    bool contains(Point location) const;
+
+    //compare two Regions
+    bool operator== (const Region& rhs) const;
+    bool operator!= (const Region& rhs) const;
+};
+
+//Identifies a single cell of a grid
+typedef long long Grid_key;
+
+//Sets cx and cy to the grid coordinates of the cell of the given size
+//that contains the location
+void get_grid_coords(Point location, double cell_size,
+                     long long& cx, long long& cy);
+
+//Combines grid coordinates into a single key
+Grid_key make_grid_key(long long cx, long long cy);
+
+//Returns the key of the cell of the given size that contains the location
+Grid_key get_grid_key(Point location, double cell_size);
+
+#endif
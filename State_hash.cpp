@@ -0,0 +1,64 @@
+#include "State_hash.h"
+#include <cstring>//memcpy
+
+using std::string;
+using std::uint64_t;
+
+const uint64_t hash_seed_c = 0x9e3779b97f4a7c15ULL;
+const uint64_t text_basis_c = 0xcbf29ce484222325ULL;
+const uint64_t text_prime_c = 0x100000001b3ULL;
+const int hash_digits_c = 16;
+
+//Nothing mixed in yet
+State_hash::State_hash() : value(hash_seed_c)
+{
+}
+
+//Each value moves the hash on by the seed too, so a run of zeros still
+//changes it
+void State_hash::add(uint64_t bits)
+{
+    value = mix_hash_bits(value + hash_seed_c + bits);
+}
+
+//The bits of the double are mixed in as they are
+void State_hash::add(double number)
+{
+    if(number == 0.) {
+        number = 0.;
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    add(bits);
+}
+
+//The characters are hashed first, then mixed in with the length
+void State_hash::add(const string& text)
+{
+    uint64_t text_hash = text_basis_c;
+    for(char c : text) {
+        text_hash = (text_hash ^ static_cast<unsigned char>(c)) * text_prime_c;
+    }
+    add(text_hash);
+    add(static_cast<uint64_t>(text.length()));
+}
+
+//The finishing step of the SplitMix64 generator
+uint64_t mix_hash_bits(uint64_t bits)
+{
+    bits = (bits ^ (bits >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    bits = (bits ^ (bits >> 27)) * 0x94d049bb133111ebULL;
+    return bits ^ (bits >> 31);
+}
+
+//Leading zeros are kept, so every hash is the same width
+string format_hash(uint64_t hash)
+{
+    const char* const digits = "0123456789abcdef";
+    string text(hash_digits_c, '0');
+    for(int i = hash_digits_c - 1; i >= 0; i--) {
+        text[i] = digits[hash & 0xf];
+        hash >>= 4;
+    }
+    return text;
+}
@@ -0,0 +1,44 @@
+/*
+State_hash boils the values that make up an object's state down to a single
+64-bit number, so two worlds can be compared without comparing everything in
+them. Values are mixed in one at a time, in order; equal states give equal
+hashes, and any difference almost certainly gives a different one.
+
+Model combines the hashes of its objects by XOR, so when one object changes,
+only its hash needs working out again: the old one is XORed out and the new
+one in. Each object's hash includes its name, so two objects swapping states
+still changes the world's hash.
+*/
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <string>
+#include <cstdint>
+
+class State_hash {
+public:
+    //Starts with nothing mixed in
+    State_hash();
+
+    //Mixes in the next value
+    void add(std::uint64_t bits);
+    void add(int number) {add(static_cast<std::uint64_t>(number));}
+    void add(bool flag) {add(static_cast<std::uint64_t>(flag));}
+    //0.0 and -0.0 are the same value, so they mix in the same way
+    void add(double number);
+    void add(const std::string& text);
+
+    //returns the hash of everything mixed in so far
+    std::uint64_t get() const {return value;}
+
+private:
+    std::uint64_t value;
+};
+
+//Scrambles the bits so that nearby inputs give unrelated outputs
+std::uint64_t mix_hash_bits(std::uint64_t bits);
+
+//Returns the hash as 16 hexadecimal digits
+std::string format_hash(std::uint64_t hash);
+
+#endif
@@ -0,0 +1,180 @@
+#include "Stats_view.h"
+#include "Model.h"
+#include "Utility.h"
+#include <ostream>
+#include <vector>
+
+using std::string;
+using std::vector;
+using std::map;
+using std::ostream;
+using std::endl;
+using std::shared_ptr;
+using std::make_shared;
+
+const char* const all_types_label_c = "all";
+
+//Stats_frame is a copy of a Stats_view's totals when it was captured:
+//for each kind of value, one row per type and a last one for all of them
+class Stats_frame : public View_frame {
+public:
+    struct Row {
+        string label;
+        int count;
+        double sum, lowest, highest;
+    };
+    typedef vector<Row> Rows;
+    
+    Stats_frame(Rows health_rows_, Rows amount_rows_) :
+    health_rows(std::move(health_rows_)), amount_rows(std::move(amount_rows_))
+    {}
+    //Outputs the count, total, average, lowest and highest of each row
+    void render(ostream& os) const override;
+private:
+    Rows health_rows;
+    Rows amount_rows;
+    
+    //Outputs the rows under the given heading, if there are any
+    static void render_rows(ostream& os, const string& heading,
+                            const Rows& rows);
+};
+
+//Returns the rows for one kind of value; types with nothing to count
+//have already been dropped, so none are empty
+Stats_frame::Rows make_rows(const map<string, Stats_view::Totals>& by_type,
+                            const Stats_view::Totals& all);
+
+//Nothing has been reported yet
+Stats_view::Stats_view(const Model& model_) : model(model_)
+{
+}
+
+//Records the health under the object's type
+void Stats_view::update_health(const string& name, double health)
+{
+    record(healths, name, health);
+}
+
+//Records the amount under the object's type
+void Stats_view::update_amount(const string& name, double amount)
+{
+    record(amounts, name, amount);
+}
+
+//A gone object no longer counts towards any total
+void Stats_view::update_remove(const string& name)
+{
+    forget(healths, name);
+    forget(amounts, name);
+}
+
+//Copies a row for each type and one for all types, for each kind of value
+shared_ptr<const View_frame> Stats_view::capture()
+{
+    return make_shared<Stats_frame>(make_rows(healths.by_type, healths.all),
+                                    make_rows(amounts.by_type, amounts.all));
+}
+
+//Starts over with no totals at all
+void Stats_view::clear()
+{
+    healths = Tracked_value();
+    amounts = Tracked_value();
+    mark_dirty();
+}
+
+//Returns a string representation of this view
+string Stats_view::get_name()
+{
+    return stats_view_name_c;
+}
+
+//An object reporting the value it last reported changes nothing. The type
+//is looked up only the first time an object reports, since it never changes.
+void Stats_view::record(Tracked_value& tracked, const string& name,
+                        double value)
+{
+    auto report_iter = tracked.reports.find(name);
+    if(report_iter != tracked.reports.end() &&
+       report_iter->second.value == value) {
+        return;
+    }
+    const char* type;
+    if(report_iter != tracked.reports.end()) {
+        type = report_iter->second.type;
+        forget(tracked, name);
+    } else {
+        type = model.get_type_name(name);
+        if(!type) return;//not an object we know anything about
+    }
+    tracked.reports[name] = Tracked_value::Last_report{type, value};
+    for(Totals* totals : {&tracked.by_type[type], &tracked.all}) {
+        totals->sum += value;
+        totals->values.insert(value);
+    }
+    mark_dirty();
+}
+
+//Types left with no objects are dropped from the totals
+void Stats_view::forget(Tracked_value& tracked, const string& name)
+{
+    auto report_iter = tracked.reports.find(name);
+    if(report_iter == tracked.reports.end()) {
+        return;
+    }
+    double value = report_iter->second.value;
+    auto type_iter = tracked.by_type.find(report_iter->second.type);
+    for(Totals* totals : {&type_iter->second, &tracked.all}) {
+        totals->sum -= value;
+        totals->values.erase(totals->values.find(value));
+    }
+    if(type_iter->second.values.empty()) {
+        tracked.by_type.erase(type_iter);
+    }
+    tracked.reports.erase(report_iter);
+    mark_dirty();
+}
+
+//Types come out in name order, followed by all of them together
+Stats_frame::Rows make_rows(const map<string, Stats_view::Totals>& by_type,
+                            const Stats_view::Totals& all)
+{
+    Stats_frame::Rows rows;
+    if(all.values.empty()) {
+        return rows;
+    }
+    auto make_row = [](const string& label, const Stats_view::Totals& totals) {
+        return Stats_frame::Row{label, static_cast<int>(totals.values.size()),
+                                totals.sum, *totals.values.begin(),
+                                *totals.values.rbegin()};
+    };
+    for(const auto& type_pair : by_type) {
+        rows.push_back(make_row(type_pair.first, type_pair.second));
+    }
+    rows.push_back(make_row(all_types_label_c, all));
+    return rows;
+}
+
+//Outputs the health rows, then the amount rows
+void Stats_frame::render(ostream& os) const
+{
+    os << "Current statistics:" << endl;
+    os << "--------------" << endl;
+    render_rows(os, "Health", health_rows);
+    render_rows(os, "Amounts", amount_rows);
+    os << "--------------" << endl;
+}
+
+//One line per row, indented under the heading
+void Stats_frame::render_rows(ostream& os, const string& heading,
+                              const Rows& rows)
+{
+    if(rows.empty()) return;
+    os << heading << ":" << endl;
+    for(const Row& row : rows) {
+        os << "  " << row.label << ": count " << row.count
+           << ", total " << row.sum << ", average " << row.sum / row.count
+           << ", lowest " << row.lowest << ", highest " << row.highest
+           << endl;
+    }
+}
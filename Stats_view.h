@@ -0,0 +1,75 @@
+/*
+Stats_view keeps running totals of the health and the amounts it hears
+about, broken down by the type of object reporting them: how many objects,
+their sum and average, and the lowest and highest value. Each change only
+adjusts the totals of its object's type, so drawing never has to look at
+the objects themselves.
+*/
+#ifndef STATS_VIEW_H
+#define STATS_VIEW_H
+
+#include "View.h"
+#include <string>
+#include <map>//totals by type
+#include <set>//values, for lowest and highest
+#include <unordered_map>//each object's last value
+#include <memory>
+
+class Model;
+
+class Stats_view : public View {
+public:
+    //Starts with no totals; types are looked up in the given world
+    Stats_view(const Model& model_);
+    
+    //Only wants health, amounts and removals
+    int get_interests() const override
+        {return HEALTH_INTEREST | AMOUNT_INTEREST | GONE_INTEREST;}
+    
+    //Each update replaces the object's old value in its type's totals
+    void update_health(const std::string& name, double health) override;
+    void update_amount(const std::string& name, double amount) override;
+    void update_remove(const std::string& name) override;
+    
+    //Captures the totals for each type, and for every object together
+    std::shared_ptr<const View_frame> capture() override;
+    
+    //Forgets every value and total
+    void clear() override;
+    
+    //Returns the internal representation of the view's name
+    std::string get_name() override;
+    
+    //The running totals of one kind of value over some set of objects.
+    //The values are kept sorted so the lowest and highest are at the ends.
+    struct Totals {
+        double sum = 0.;
+        std::multiset<double> values;
+    };
+    
+private:
+    const Model& model;
+    
+    //One kind of value: the last one each object reported, along with its
+    //type, and the totals for each type and for all types together
+    struct Tracked_value {
+        struct Last_report {
+            const char* type;
+            double value;
+        };
+        std::unordered_map<std::string, Last_report> reports;
+        std::map<std::string, Totals> by_type;
+        Totals all;
+    };
+    
+    Tracked_value healths;
+    Tracked_value amounts;
+    
+    //Replaces the object's last value, if any, with the new one
+    void record(Tracked_value& tracked, const std::string& name,
+                double value);
+    //Takes the object's last value, if any, out of the totals
+    void forget(Tracked_value& tracked, const std::string& name);
+};
+
+#endif
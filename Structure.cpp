@@ -1,9 +1,9 @@
 #include "Structure.h"
 #include "Model.h"
-#include <iostream>//cout, endl
+#include "State_hash.h"
+#include <ostream>//endl
 
 using std::string;
-using std::cout;
 using std::endl;
 
 const double default_amount_c = 0.0;
@@ -21,12 +21,19 @@ Structure::~Structure()
 //Simply outputs name and location of structure
 void Structure::describe() const
 {
-    cout << get_name() << " at " << cur_location << endl;
+    get_output() << get_name() << " at " << cur_location << endl;
+}
+//A structure never moves, but where it stands is still its state
+void Structure::hash_state(State_hash& hash) const
+{
+    Sim_object::hash_state(hash);
+    hash.add(cur_location.x);
+    hash.add(cur_location.y);
 }
 //Notifies model of the current location
 void Structure::broadcast_current_state()
 {
-    Model::get_instance().notify_location(get_name(), get_location());
+    get_model().notify_location(get_name(), get_location());
     
 }
 //Returns a default amt
@@ -4,6 +4,7 @@
 #define STRUCTURE_H
 
 #include <string>
+#include <memory>
 #include "Geometry.h"//needed for internal Point
 #include "Sim_object.h"
 
@@ -17,11 +18,16 @@ public:
     //Returns the current location
     virtual Point get_location() const { return cur_location; }
     
+    //returns a copy of this structure, to be added to another world
+    virtual std::shared_ptr<Structure> clone() const = 0;
+    
     //Updates the given concrete structure; for abstract, does nothing
     virtual void update(){}
     
     // output information about the current state
     virtual void describe() const;
+    //mixes in the location
+    void hash_state(State_hash& hash) const override;
     
     // ask model to notify views of current state
     virtual void broadcast_current_state();
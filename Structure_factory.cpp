@@ -2,28 +2,41 @@
 #include "Town_Hall.h"
 #include "Farm.h"
 #include "Geometry.h"
+#include "Type_registry.h"
 #include "Utility.h"
 
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
-const char* const farm_name_c = "Farm";
-const char* const town_hall_name_c = "Town_Hall";
+//every kind of Structure the factory can make
+typedef Type_registry<Structure, Farm, Town_Hall> Structure_registry;
 
-//Creates a structure as requested by comparing the type to the currently
-//known type names, and calling the relevant constructor.
+//Creates a structure as requested by looking the type up in the registry
+//of known types, and calling the relevant constructor.
 //Throws an error if it can't recognize the type. 
 shared_ptr<Structure>
 create_structure(const string& name, const string& type,
                  Point location)
 {
-    if(type == farm_name_c) {
-        return shared_ptr<Structure>{new Farm{name, location}};
-    }
-    else if(type == town_hall_name_c) {
-        return shared_ptr<Structure>{new Town_Hall{name, location}};
+    shared_ptr<Structure> structure =
+        Structure_registry::create(type_name_hash(type.c_str()), type,
+                                   name, location);
+    if(!structure) {
+        throw Error{"Trying to create structure of unknown type!"};
     }
-    else {
+    return structure;
+}
+
+//Looks the type up once, then makes all the Structures together
+vector<shared_ptr<Structure>>
+create_structures(const string& type, const vector<string>& names,
+                  const vector<Point>& locations)
+{
+    vector<shared_ptr<Structure>> structures;
+    if(!Structure_registry::create_many(type_name_hash(type.c_str()), type,
+                                        names, locations, structures)) {
         throw Error{"Trying to create structure of unknown type!"};
     }
+    return structures;
 }
@@ -2,6 +2,7 @@
 #define STRUCTURE_FACTORY_H
 
 #include <string>
+#include <vector>
 #include <memory>
 
 struct Point;
@@ -12,4 +13,13 @@ class Structure;
 // The Structure is allocated with new, so some other component is resposible for deleting it.
 std::shared_ptr<Structure> create_structure(const std::string& name, const std::string& type, Point location);
 
+// Create one Structure of the specified type for each name, at the location
+// with the same index, in a single shared block of memory. names and
+// locations must be the same length. If the type is unrecognized,
+// throws Error("Trying to create structure of unknown type!")
+std::vector<std::shared_ptr<Structure>>
+create_structures(const std::string& type,
+                  const std::vector<std::string>& names,
+                  const std::vector<Point>& locations);
+
 #endif
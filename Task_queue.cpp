@@ -0,0 +1,107 @@
+#include "Task_queue.h"
+#include <ostream>//endl
+#include <chrono>//steady_clock
+
+using std::string;
+using std::endl;
+using std::chrono::steady_clock;
+using std::chrono::microseconds;
+
+//Nothing waits until there is a budget
+Task_queue::Task_queue() : next_kind(0), budget(0)
+{
+}
+
+//Tasks left waiting when the budget is removed run on the next tick
+void Task_queue::set_budget(int microseconds_)
+{
+    budget = microseconds_;
+}
+
+//A task run at once still counts towards its kind's totals
+void Task_queue::post(const string& kind_name, Task task, int time)
+{
+    Kind& kind = get_kind(kind_name);
+    Job job{task, time};
+    if(budget == 0 && kind.jobs.empty()) {
+        run_job(kind, job, time);
+        return;
+    }
+    kind.jobs.push_back(job);
+}
+
+//Checks the clock after each task; the first task of the tick always runs
+int Task_queue::run(int time)
+{
+    steady_clock::time_point deadline =
+        steady_clock::now() + microseconds(budget);
+    int tasks_run = 0;
+    int empty_kinds = 0;//kinds found empty in a row
+    while(empty_kinds < static_cast<int>(kinds.size())) {
+        if(budget > 0 && tasks_run > 0 && steady_clock::now() >= deadline) {
+            break;
+        }
+        Kind& kind = kinds[next_kind];
+        next_kind = (next_kind + 1) % kinds.size();
+        if(kind.jobs.empty()) {
+            empty_kinds++;
+            continue;
+        }
+        empty_kinds = 0;
+        Job job = kind.jobs.front();
+        kind.jobs.pop_front();
+        run_job(kind, job, time);
+        tasks_run++;
+    }
+    return tasks_run;
+}
+
+//Adds up every kind's line
+int Task_queue::size() const
+{
+    int waiting = 0;
+    for(const Kind& kind : kinds) {
+        waiting += static_cast<int>(kind.jobs.size());
+    }
+    return waiting;
+}
+
+//One line per kind of work
+void Task_queue::describe(std::ostream& os) const
+{
+    os << "Task budget: ";
+    if(budget > 0)
+        os << budget << " microseconds per tick" << endl;
+    else
+        os << "none" << endl;
+    for(const Kind& kind : kinds) {
+        os << "   " << kind.name << ": " << kind.tasks_run << " run, "
+            << kind.jobs.size() << " waiting, average delay "
+            << (kind.tasks_run ? double(kind.total_delay) / kind.tasks_run : 0.)
+            << " ticks, longest " << kind.max_delay << endl;
+    }
+}
+
+//Kinds are never removed, so the turn order stays fixed
+Task_queue::Kind& Task_queue::get_kind(const string& name)
+{
+    for(Kind& kind : kinds) {
+        if(kind.name == name) {
+            return kind;
+        }
+    }
+    kinds.push_back(Kind{name, std::deque<Job>(), 0, 0, 0});
+    return kinds.back();
+}
+
+//Delay is measured in ticks from posting to running
+void Task_queue::run_job(Kind& kind, Job& job, int time)
+{
+    int delay = time - job.posted;
+    kind.tasks_run++;
+    kind.total_delay += delay;
+    if(delay > kind.max_delay) {
+        kind.max_delay = delay;
+    }
+    job.task();
+}
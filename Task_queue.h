@@ -0,0 +1,73 @@
+/*
+Task_queue spreads work that doesn't have to be finished right away, such
+as Archers looking for new targets or re-planning logistics, over as many
+ticks as it takes to keep each tick within a time budget.
+
+Tasks are posted under a kind of work. Each kind waits in its own line, and
+the queue serves the kinds in turn, one task at a time, so a flood of one
+kind can't hold up the others. Each tick Model runs tasks until the budget
+is spent; at least one task runs every tick, so the queue always drains
+eventually. How many ticks each task waited is recorded per kind.
+
+With no budget, which is the default, tasks run the moment they are posted,
+just as if they had been called directly.
+*/
+#ifndef TASK_QUEUE_H
+#define TASK_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <iosfwd>//ostream
+
+class Task_queue {
+public:
+    typedef std::function<void()> Task;
+
+    //Creates a queue with no budget
+    Task_queue();
+
+    //Sets how many microseconds run may spend each tick; 0 means no limit,
+    //and tasks are run as soon as they are posted
+    void set_budget(int microseconds);
+    int get_budget() const {return budget;}
+
+    //Adds the task to the end of the named kind's line, noting that it was
+    //posted at time; without a budget, runs it right away instead
+    void post(const std::string& kind, Task task, int time);
+
+    //Runs tasks, taking one from each kind in turn, until the budget has
+    //been spent or no tasks are left. Returns the number of tasks run.
+    int run(int time);
+
+    //returns the number of tasks waiting
+    int size() const;
+
+    //outputs how many tasks of each kind have run and waited, and for
+    //how long, to the stream
+    void describe(std::ostream& os) const;
+
+private:
+    struct Job {
+        Task task;
+        int posted;//the time it was posted
+    };
+    struct Kind {
+        std::string name;
+        std::deque<Job> jobs;
+        long tasks_run;
+        long total_delay;//ticks waited, over all the tasks run
+        int max_delay;
+    };
+    std::vector<Kind> kinds;//few enough to search
+    std::size_t next_kind;//whose turn it is
+    int budget;
+
+    //returns the named kind, adding it if it is new
+    Kind& get_kind(const std::string& name);
+    //runs the task, noting how long it waited
+    void run_job(Kind& kind, Job& job, int time);
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "Telemetry_view.h"
+#include "Binary_writer.h"
+#include "Geometry.h"
+#include "Model.h"
+#include "Utility.h"
+
+using std::string;
+
+const char* const telemetry_magic_c = "P5TL";
+const uint16_t telemetry_version_c = 1;
+
+//Opens the file and writes the header; no tick has been written yet
+Telemetry_view::Telemetry_view(const Model& model_, const string& filename) :
+model(model_), writer(new Binary_writer(filename)), last_tick(-1)
+{
+    writer->append(telemetry_magic_c, 4);
+    writer->put(telemetry_version_c);
+}
+
+//The writer flushes itself when destroyed
+Telemetry_view::~Telemetry_view()
+{
+}
+
+//Appends a Location record
+void Telemetry_view::update_location(const string& name, Point location)
+{
+    start_record(LOCATION_RECORD, name);
+    writer->put(location.x);
+    writer->put(location.y);
+}
+
+//Appends an Amount record
+void Telemetry_view::update_amount(const string& name, double amount)
+{
+    start_record(AMOUNT_RECORD, name);
+    writer->put(amount);
+}
+
+//Appends a Health record
+void Telemetry_view::update_health(const string& name, double health)
+{
+    start_record(HEALTH_RECORD, name);
+    writer->put(health);
+}
+
+//Appends a Gone record; the id is never reused
+void Telemetry_view::update_remove(const string& name)
+{
+    start_record(GONE_RECORD, name);
+}
+
+//Returns a string representation of this view
+string Telemetry_view::get_name()
+{
+    return telemetry_view_name_c;
+}
+
+//Ids are handed out in the order names are first seen
+void Telemetry_view::start_record(Record_tag_e tag, const string& name)
+{
+    int tick = model.get_time();
+    if(tick != last_tick) {
+        writer->put(static_cast<uint8_t>(TICK_RECORD));
+        writer->put(static_cast<int32_t>(tick));
+        last_tick = tick;
+    }
+    auto id_iter = ids.find(name);
+    if(id_iter == ids.end()) {
+        uint32_t new_id = static_cast<uint32_t>(ids.size());
+        id_iter = ids.insert(make_pair(name, new_id)).first;
+        writer->put(static_cast<uint8_t>(NAME_RECORD));
+        writer->put(new_id);
+        writer->put_string(name);
+    }
+    writer->put(static_cast<uint8_t>(tag));
+    writer->put(id_iter->second);
+}
@@ -0,0 +1,71 @@
+/*
+Telemetry_view streams every change it hears about to a binary file or pipe,
+so other programs can follow the simulation without parsing console output.
+It shows nothing on the console itself.
+
+File format (all numbers in the machine's byte order):
+    header:   char[4] "P5TL", uint16_t version
+    then a sequence of records, each starting with a uint8_t tag:
+    Name      tag 0, uint32_t id, uint16_t length, char[length]
+              gives the name an id; comes before the id is first used
+    Tick      tag 1, int32_t time
+              every record after this one happened at that time
+    Location  tag 2, uint32_t id, double x, double y
+    Amount    tag 3, uint32_t id, double amount
+    Health    tag 4, uint32_t id, double health
+    Gone      tag 5, uint32_t id
+When the view is opened it first writes the state of every object, so the
+state of the world at any tick can be rebuilt by replaying the records up
+to the next Tick record.
+*/
+#ifndef TELEMETRY_VIEW_H
+#define TELEMETRY_VIEW_H
+
+#include "View.h"
+#include <string>
+#include <map>//names to ids
+#include <memory>
+#include <cstdint>
+
+class Binary_writer;
+class Model;
+
+class Telemetry_view : public View {
+public:
+    //Opens the file and writes the header.
+    //Throws Error("Could not open output file!") if it can't.
+    //Ticks are read from the given world's clock.
+    Telemetry_view(const Model& model_, const std::string& filename);
+    //Flushes the file; defined out of line where Binary_writer is complete
+    ~Telemetry_view();
+
+    //Each update is appended as a record
+    void update_location(const std::string& name, Point location) override;
+    void update_amount(const std::string& name, double amount) override;
+    void update_health(const std::string& name, double health) override;
+    void update_remove(const std::string& name) override;
+
+    //Returns the internal representation of the view's name
+    std::string get_name() override;
+
+private:
+    enum Record_tag_e : uint8_t {
+        NAME_RECORD,
+        TICK_RECORD,
+        LOCATION_RECORD,
+        AMOUNT_RECORD,
+        HEALTH_RECORD,
+        GONE_RECORD
+    };
+
+    const Model& model;
+    std::unique_ptr<Binary_writer> writer;
+    std::map<std::string, uint32_t> ids;
+    int last_tick;
+
+    //Writes a Tick record if time has moved on since the last record,
+    //then the tag and id of a new record, defining the id if it is new
+    void start_record(Record_tag_e tag, const std::string& name);
+};
+
+#endif
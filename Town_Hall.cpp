@@ -1,13 +1,15 @@
 #include "Town_Hall.h"
 #include "Model.h"
-#include <iostream>//cout , endl
+#include "State_hash.h"
+#include "Binary_writer.h"
+#include "Binary_reader.h"
+#include <ostream>//endl
 
 const double default_food_c = 0.0;
 const double tax_on_food_c = 0.1;
 const double min_food_withdrawal_c = 1.0;
 
 using std::string;
-using std::cout;
 using std::endl;
 //constructs and announces construction of Town Hall
 Town_Hall::Town_Hall(const string& name_, Point location) :
@@ -17,6 +19,7 @@ Structure(name_, location), food(default_food_c)
 //deposits the given amount to Town Hall, no other scruples
 void Town_Hall::deposit(double deposit_amount)
 {
+    will_change();
     food += deposit_amount;
     broadcast_current_state();//let Model know about changes to food
 }
@@ -26,12 +29,14 @@ void Town_Hall::deposit(double deposit_amount)
 //if < min_food_withdrawal_c is left, return nothing
 double Town_Hall::withdraw(double amount_to_obtain)
 {
+    will_change();
     double avail_amt = food - (food * tax_on_food_c);//get food - tax 
     if(avail_amt < min_food_withdrawal_c) {
         avail_amt = default_food_c;
     }
     if(amount_to_obtain > avail_amt) {
         food -= avail_amt;
+        broadcast_current_state();//views rely on hearing every change
         return avail_amt;
     }
     food -= amount_to_obtain;
@@ -42,13 +47,29 @@ double Town_Hall::withdraw(double amount_to_obtain)
 //Otherwise delegates back to Structure::describe()
 void Town_Hall::describe() const
 {
-    cout << "Town_Hall ";
+    get_output() << "Town_Hall ";
     Structure::describe();
-    cout << "   Contains " << food << endl;
+    get_output() << "   Contains " << food << endl;
+}
+//Only the food on hand can change
+void Town_Hall::hash_state(State_hash& hash) const
+{
+    Structure::hash_state(hash);
+    hash.add(food);
+}
+//Only the food on hand can change
+void Town_Hall::write_state(Binary_writer& writer) const
+{
+    writer.put(food);
+}
+//Read back just as written
+void Town_Hall::read_state(Binary_reader& reader)
+{
+    food = reader.get<double>();
 }
 //broadcasts additional information on current amount in town_hall
 void Town_Hall::broadcast_current_state()
 {
     Structure::broadcast_current_state();
-    Model::get_instance().notify_amount(get_name(), food);
+    get_model().notify_amount(get_name(), food);
 }
@@ -13,8 +13,16 @@ struct Point;//forward declare
 class Town_Hall : public Structure{
 
 public:
+    //the name this type is created by
+    static constexpr const char* type_name() {return "Town_Hall";}
+    const char* get_type_name() const override {return type_name();}
+
     //Constructs a Town Hall with the given name and location
 	Town_Hall (const std::string& name_, Point location_);
+    std::shared_ptr<Structure> clone() const override
+        {return std::make_shared<Town_Hall>(*this);}
+    void restore(const Sim_object& saved) override
+        {*this = static_cast<const Town_Hall&>(saved);}
 	
 	// deposit adds in the supplied amount
 	void deposit(double deposit_amount) override;
@@ -26,6 +34,11 @@ public:
 
 	// output information about the current state
 	void describe() const override;
+	// mixes in the food on hand
+	void hash_state(State_hash& hash) const override;
+	// writes or reads back the food on hand, for a snapshot
+	void write_state(Binary_writer& writer) const override;
+	void read_state(Binary_reader& reader) override;
     //broadcasts additional information on the current amount of food
     //it has available
     void broadcast_current_state() override;
@@ -0,0 +1,108 @@
+#include "Trace_writer.h"
+#include "Binary_writer.h"
+#include "Geometry.h"
+#include <vector>
+#include <limits>//quiet_NaN
+
+using std::string;
+using std::map;
+using std::vector;
+
+const char* const trace_magic_c = "P5TR";
+const char* const trace_block_magic_c = "BLK";
+const uint16_t trace_version_c = 1;
+const std::size_t trace_alignment_c = 8;
+const std::size_t trace_column_name_size_c = 8;
+const uint32_t trace_num_columns_c = 6;
+
+//Opens the file and writes the header
+Trace_writer::Trace_writer(const string& filename) :
+writer(new Binary_writer(filename))
+{
+    writer->append(trace_magic_c, 4);
+    writer->put(trace_version_c);
+    writer->pad_to(trace_alignment_c);
+}
+
+//The writer flushes itself when destroyed
+Trace_writer::~Trace_writer()
+{
+}
+
+//Gathers each column into its own array, walking the three maps side by
+//side since they are all in name order, then writes them one after another
+void Trace_writer::write_block(int time, const map<string, Point>& locations,
+                               const map<string, double>& healths,
+                               const map<string, double>& amounts)
+{
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    std::size_t rows = locations.size();
+    vector<char> new_names;
+    vector<uint32_t> id_column;
+    vector<double> x_column, y_column, health_column, amount_column;
+    id_column.reserve(rows);
+    x_column.reserve(rows);
+    y_column.reserve(rows);
+    health_column.reserve(rows);
+    amount_column.reserve(rows);
+    auto health_iter = healths.begin();
+    auto amount_iter = amounts.begin();
+    for(const auto& loc_pair : locations) {
+        const string& name = loc_pair.first;
+        auto id_iter = ids.find(name);
+        if(id_iter == ids.end()) {
+            uint32_t new_id = static_cast<uint32_t>(ids.size());
+            id_iter = ids.insert(make_pair(name, new_id)).first;
+            uint16_t length = static_cast<uint16_t>(name.size());
+            const char* id_bytes = reinterpret_cast<const char*>(&new_id);
+            const char* len_bytes = reinterpret_cast<const char*>(&length);
+            new_names.insert(new_names.end(), id_bytes,
+                             id_bytes + sizeof(new_id));
+            new_names.insert(new_names.end(), len_bytes,
+                             len_bytes + sizeof(length));
+            new_names.insert(new_names.end(), name.begin(), name.end());
+        }
+        id_column.push_back(id_iter->second);
+        x_column.push_back(loc_pair.second.x);
+        y_column.push_back(loc_pair.second.y);
+        while(health_iter != healths.end() && health_iter->first < name)
+            health_iter++;
+        bool has_health = health_iter != healths.end() &&
+            health_iter->first == name;
+        health_column.push_back(has_health ? health_iter->second : missing);
+        while(amount_iter != amounts.end() && amount_iter->first < name)
+            amount_iter++;
+        bool has_amount = amount_iter != amounts.end() &&
+            amount_iter->first == name;
+        amount_column.push_back(has_amount ? amount_iter->second : missing);
+    }
+    writer->append(trace_block_magic_c, 4);
+    writer->put(static_cast<int32_t>(time));
+    writer->put(static_cast<uint64_t>(rows));
+    writer->put(trace_num_columns_c);
+    writer->put(static_cast<uint32_t>(0));
+    write_column("names", BYTES_COLUMN, new_names.data(), new_names.size());
+    write_column("id", UINT32_COLUMN, id_column.data(),
+                 rows * sizeof(uint32_t));
+    write_column("x", DOUBLE_COLUMN, x_column.data(), rows * sizeof(double));
+    write_column("y", DOUBLE_COLUMN, y_column.data(), rows * sizeof(double));
+    write_column("health", DOUBLE_COLUMN, health_column.data(),
+                 rows * sizeof(double));
+    write_column("amount", DOUBLE_COLUMN, amount_column.data(),
+                 rows * sizeof(double));
+    writer->flush();
+}
+
+//Column names are padded with zeros to a fixed width
+void Trace_writer::write_column(const char* name, Column_type_e type,
+                                const void* data, std::size_t length)
+{
+    string padded_name(name);
+    padded_name.resize(trace_column_name_size_c, '\0');
+    writer->append(padded_name.data(), trace_column_name_size_c);
+    writer->put(static_cast<uint32_t>(type));
+    writer->put(static_cast<uint32_t>(0));
+    writer->put(static_cast<uint64_t>(length));
+    writer->append(data, length);
+    writer->pad_to(trace_alignment_c);
+}
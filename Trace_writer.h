@@ -0,0 +1,68 @@
+/*
+Trace_writer dumps the full state of every object to a binary file as a
+series of columnar blocks, one per traced tick, for offline analysis. Each
+column is one contiguous, 8-byte aligned array of a single type, so a reader
+that memory-maps the file can scan one column over all rows without decoding
+the others.
+
+File format (all numbers in the machine's byte order):
+    header:   char[4] "P5TR", uint16_t version, then padding to 8 bytes
+    then one block per traced tick:
+    block header:   char[4] "BLK", int32_t time, uint64_t rows,
+                    uint32_t number of columns, uint32_t zero
+    then for each column:
+    column header:  char[8] name, uint32_t type, uint32_t zero,
+                    uint64_t length of the data in bytes
+    column data:    length bytes, then padding to 8 bytes
+Column types are 0 for uint32_t, 1 for double, and 2 for raw bytes. Each
+block has these columns, in this order:
+    "names"   bytes:  the names first seen in this block, each as
+                      uint32_t id, uint16_t length, char[length]
+    "id"      uint32_t[rows]:  the object in each row
+    "x", "y"  double[rows]:    its location
+    "health"  double[rows]:    its health, or NaN for a Structure
+    "amount"  double[rows]:    food stored by a Farm or Town_Hall, or carried
+                               by a Peasant; NaN for other objects
+Rows are in name order.
+*/
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include <string>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+class Binary_writer;
+struct Point;
+
+class Trace_writer {
+public:
+    //Opens the file and writes its header.
+    //Throws Error("Could not open output file!") if it can't.
+    Trace_writer(const std::string& filename);
+    //Flushes the file; defined out of line where Binary_writer is complete
+    ~Trace_writer();
+
+    //Writes one block holding every object's state at the given time
+    void write_block(int time,
+                     const std::map<std::string, Point>& locations,
+                     const std::map<std::string, double>& healths,
+                     const std::map<std::string, double>& amounts);
+
+private:
+    enum Column_type_e : uint32_t {
+        UINT32_COLUMN,
+        DOUBLE_COLUMN,
+        BYTES_COLUMN
+    };
+
+    std::unique_ptr<Binary_writer> writer;
+    std::map<std::string, uint32_t> ids;
+
+    //Writes a column header followed by the data and its padding
+    void write_column(const char* name, Column_type_e type,
+                      const void* data, std::size_t length);
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+Type_registry maps type names, such as "Soldier", to the classes that
+create_agent and create_structure can make, without comparing the name
+against every known type. Each concrete class registers itself by declaring
+    static constexpr const char* type_name() {return "Soldier";}
+and being listed in a factory's registry, e.g.
+    typedef Type_registry<Agent, Soldier, Peasant, Archer> Agent_registry;
+The names are hashed at compile time; a static_assert checks that no two
+registered names hash alike, so the hash is perfect over the registered
+set. Looking a name up costs one hash of the name, a few integer compares,
+and one string compare to make sure it really is that type.
+
+Objects can be made one at a time, or many at once into pooled storage.
+*/
+#ifndef TYPE_REGISTRY_H
+#define TYPE_REGISTRY_H
+
+#include "Geometry.h"//Point
+#include "Pool_allocator.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+//the FNV-1a hash of a string; usable at compile time and at run time
+constexpr uint32_t type_name_hash(const char* str,
+                                  uint32_t hash = 2166136261u)
+{
+    return *str ? type_name_hash(str + 1,
+                                 (hash ^ static_cast<unsigned char>(*str)) *
+                                 16777619u)
+                : hash;
+}
+
+//true if the hash of T's name matches the hash of any of Others' names
+template<typename T, typename... Others>
+struct Hash_collides;
+template<typename T>
+struct Hash_collides<T> {
+    static constexpr bool value = false;
+};
+template<typename T, typename First, typename... Rest>
+struct Hash_collides<T, First, Rest...> {
+    static constexpr bool value =
+        type_name_hash(T::type_name()) == type_name_hash(First::type_name()) ||
+        Hash_collides<T, Rest...>::value;
+};
+
+//true if every type's name hashes differently
+template<typename... Types>
+struct Hashes_distinct;
+template<>
+struct Hashes_distinct<> {
+    static constexpr bool value = true;
+};
+template<typename First, typename... Rest>
+struct Hashes_distinct<First, Rest...> {
+    static constexpr bool value = !Hash_collides<First, Rest...>::value &&
+        Hashes_distinct<Rest...>::value;
+};
+
+template<typename Base, typename... Types>
+class Type_registry;
+
+//An empty registry knows no types
+template<typename Base>
+class Type_registry<Base> {
+public:
+    static std::shared_ptr<Base> create(uint32_t, const std::string&,
+                                        const std::string&, Point)
+        {return nullptr;}
+    static bool create_many(uint32_t, const std::string&,
+                            const std::vector<std::string>&,
+                            const std::vector<Point>&,
+                            std::vector<std::shared_ptr<Base>>&)
+        {return false;}
+};
+
+template<typename Base, typename First, typename... Rest>
+class Type_registry<Base, First, Rest...> {
+    static_assert(Hashes_distinct<First, Rest...>::value,
+                  "Two registered type names have the same hash!");
+public:
+    //Makes one object of the named type, or returns nullptr if the type is
+    //not registered. type_hash must be type_name_hash(type.c_str()).
+    static std::shared_ptr<Base> create(uint32_t type_hash,
+                                        const std::string& type,
+                                        const std::string& name,
+                                        Point location)
+    {
+        if(type_hash == type_name_hash(First::type_name()) &&
+           type == First::type_name()) {
+            return std::make_shared<First>(name, location);
+        }
+        return Type_registry<Base, Rest...>::create(type_hash, type,
+                                                    name, location);
+    }
+
+    //Makes one object of the named type for each name and location,
+    //appending them to result. They all live in a single block of memory,
+    //sized from what allocate_shared was seen to ask for the first time.
+    //Returns false if the type is not registered.
+    static bool create_many(uint32_t type_hash, const std::string& type,
+                            const std::vector<std::string>& names,
+                            const std::vector<Point>& locations,
+                            std::vector<std::shared_ptr<Base>>& result)
+    {
+        if(type_hash != type_name_hash(First::type_name()) ||
+           type != First::type_name()) {
+            return Type_registry<Base, Rest...>::create_many(type_hash, type,
+                                                             names, locations,
+                                                             result);
+        }
+        static const Allocation_size slot =
+            shared_allocation_size<First>(std::string(), Point());
+        std::shared_ptr<Pool_block> block = std::make_shared<Pool_block>(
+            names.size() * slot.size + slot.alignment);
+        Pool_allocator<First> allocator(block);
+        result.reserve(result.size() + names.size());
+        for(std::size_t i = 0; i < names.size(); i++) {
+            result.push_back(std::allocate_shared<First>(allocator, names[i],
+                                                         locations[i]));
+        }
+        return true;
+    }
+};
+
+#endif
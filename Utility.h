@@ -3,6 +3,8 @@
 
 #include <string>
 #include <exception>
+#include <ostream>//muted streams
+#include <streambuf>
 
 /* Utility declarations, functions, and classes used by other modules */
 
@@ -17,8 +19,57 @@ private:
 	const std::string msg;
 };
 
+// Throws away everything written to the stream for as long as it exists, so
+// many objects can be ordered about without each reporting back. Only that
+// stream is muted, so other worlds writing elsewhere are not affected.
+class Output_muter {
+public:
+    Output_muter(std::ostream& os_) :
+        os(os_), old_buffer(os_.rdbuf(&null_buffer)) {}
+    ~Output_muter() {os.rdbuf(old_buffer);}
+private:
+    struct Null_buffer : public std::streambuf {
+        int overflow(int c) override {return traits_type::not_eof(c);}
+    };
+    Null_buffer null_buffer;
+    std::ostream& os;
+    std::streambuf* old_buffer;
+
+	// disallow copy/move construction or assignment
+	Output_muter(const Output_muter&) = delete;
+	Output_muter& operator= (const Output_muter&)  = delete;
+};
+
+// Reads through to another stream buffer, keeping a copy of every character
+// taken, so the text a command was read from can be journaled exactly as it
+// was typed. Characters only looked at are not kept until they are taken.
+class Input_recorder : public std::streambuf {
+public:
+    Input_recorder(std::streambuf* source_) : source(source_) {}
+    // returns everything taken since the last clear
+    const std::string& get_recorded() const {return recorded;}
+    void clear() {recorded.clear();}
+protected:
+    int_type underflow() override {return source->sgetc();}
+    int_type uflow() override
+    {
+        int_type c = source->sbumpc();
+        if(!traits_type::eq_int_type(c, traits_type::eof())) {
+            recorded += traits_type::to_char_type(c);
+        }
+        return c;
+    }
+private:
+    std::streambuf* source;
+    std::string recorded;
+};
+
 const char* const map_view_name_c = "map";
 const char* const health_view_name_c = "health";
 const char* const amounts_view_name_c = "amounts";
+const char* const telemetry_view_name_c = "telemetry";
+const char* const stats_view_name_c = "stats";
+const char* const heatmap_view_name_c = "heatmap";
+const char* const history_view_name_c = "history";
 
 #endif
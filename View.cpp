@@ -1,5 +1,95 @@
 #include "View.h"
 #include "Geometry.h"
+#include "Spatial_grid.h"
+#include "Utility.h"//Error
+#include <ostream>
+
+using std::string;
+using std::shared_ptr;
+using std::make_shared;
+
+//Unchanged_frame stands in for a view that has nothing new to show
+class Unchanged_frame : public View_frame {
+public:
+    Unchanged_frame(const string& view_name_, int last_drawn_) :
+    view_name(view_name_), last_drawn(last_drawn_)
+    {}
+    //Says which view is unchanged, and since when
+    void render(std::ostream& os) const override
+    {
+        os << view_name << ": unchanged since time " << last_drawn
+           << std::endl;
+    }
+private:
+    string view_name;
+    int last_drawn;
+};
+
+//Starts out dirty and never drawn, redrawing whenever asked
+View::View() : dirty(true), refresh_interval(0), last_drawn(-1)
+{
+}
+
+//Hands each entry of the snapshot the view wants to the matching update,
+//skipping locations outside the view's region if it has one
+void View::sync(const View_snapshot& snapshot)
+{
+    int interests = get_interests();
+    if(interests & LOCATION_INTEREST) {
+        Region region;
+        bool has_region = get_region(region);
+        for(const auto& loc_pair : snapshot.locations) {
+            if(!has_region || region.contains(loc_pair.second))
+                update_location(loc_pair.first, loc_pair.second);
+        }
+    }
+    if(interests & HEALTH_INTEREST) {
+        for(const auto& health_pair : snapshot.healths)
+            update_health(health_pair.first, health_pair.second);
+    }
+    if(interests & AMOUNT_INTEREST) {
+        for(const auto& amount_pair : snapshot.amounts)
+            update_amount(amount_pair.first, amount_pair.second);
+    }
+}
+
+//Captures the view and renders the frame to os right away
+void View::draw(std::ostream& os)
+{
+    std::shared_ptr<const View_frame> frame = capture();
+    if(frame) {
+        frame->render(os);
+    }
+}
+
+//A view that was drawn and hasn't changed since gets a marker; one that
+//has changed waits until its interval has passed since the last drawing.
+//A capture of nothing doesn't count as a drawing.
+shared_ptr<const View_frame> View::capture_if_due(int time)
+{
+    if(!dirty) {
+        if(last_drawn < 0) return nullptr;
+        return make_shared<Unchanged_frame>(get_name(), last_drawn);
+    }
+    if(last_drawn >= 0 && time - last_drawn < refresh_interval) {
+        return nullptr;
+    }
+    shared_ptr<const View_frame> frame = capture();
+    if(frame) {
+        dirty = false;
+        last_drawn = time;
+    }
+    return frame;
+}
+
+//Rejects negative intervals
+void View::set_refresh_interval(int ticks)
+{
+    if(ticks < 0) {
+        throw Error{"Refresh interval must not be negative!"};
+    }
+    refresh_interval = ticks;
+}
 
 //provides an interface to use this function; does nothing by default
 //Included here so Point doesn't need to be defined in View.h
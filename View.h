@@ -3,14 +3,68 @@
 #define VIEW_H
 
 #include <string>
-class Point;
+#include <map>//snapshot maps
+#include <memory>//captured frames
+#include <iosfwd>//ostream
+struct Point;
+struct Region;
+
+//A View_frame is an immutable copy of what a View shows, taken when the
+//view is captured. It can be rendered later, on any thread, without
+//touching the view or the Model again.
+class View_frame {
+public:
+    virtual ~View_frame() {}
+    //Formats the frame and writes it to the stream
+    virtual void render(std::ostream& os) const = 0;
+};
+
+//A read-only look at the latest known state of every object, handed to a
+//View in a single call so it can catch up all at once.
+struct View_snapshot {
+    const std::map<std::string, Point>& locations;
+    const std::map<std::string, double>& healths;
+    const std::map<std::string, double>& amounts;
+};
+
 /*View provides an interface for the various Views
  to use; it provides no actual implementation for anything.
+ A View tells Model which kinds of change it wants to hear about,
+ and optionally which part of the world it cares about; Model
+ only sends it those updates.
+ A View also remembers whether what it shows has changed since it was
+ last drawn, so Model can skip redrawing views that haven't, and can be
+ told to redraw no more often than every so many ticks.
  */
 class View {
 public:
+    //The kinds of change a View can subscribe to; combine with |
+    enum Interest_e {
+        NO_INTERESTS = 0,
+        LOCATION_INTEREST = 1 << 0,
+        AMOUNT_INTEREST = 1 << 1,
+        HEALTH_INTEREST = 1 << 2,
+        GONE_INTEREST = 1 << 3,
+        ALL_INTERESTS = LOCATION_INTEREST | AMOUNT_INTEREST |
+            HEALTH_INTEREST | GONE_INTEREST
+    };
+
     virtual ~View() = 0;//make pure virtual class
     
+    //Returns the Interest_e flags of the updates this view wants.
+    //By default a view wants everything.
+    virtual int get_interests() const {return ALL_INTERESTS;}
+    
+    //If the view only wants location and gone updates for objects inside
+    //part of the world, sets region to that part and returns true.
+    //Returns false by default, meaning the whole world.
+    virtual bool get_region(Region& region) const {return false;}
+    
+    //Brings a freshly attached view up to date with the whole world.
+    //By default feeds each entry it is interested in to the matching
+    //update function; views that can take a whole map at once override it.
+    virtual void sync(const View_snapshot& snapshot);
+    
 	//Takes in a name and a location, and updates it
     //Does nothing for the abstract class
 	virtual void update_location(const std::string& name,
@@ -28,8 +82,23 @@ public:
 	// Remove the name and its location; no error if the name is not present.
     virtual void update_remove(const std::string& name) {}
 	
-	// prints out the current view
-    virtual void draw() {}
+	// prints out the current view, by capturing it and rendering the
+    // frame straight to os
+    void draw(std::ostream& os);
+    
+    // Returns a frame holding a copy of everything draw() would show, or
+    // nullptr if the view has nothing to show. Does no output itself.
+    virtual std::shared_ptr<const View_frame> capture() {return nullptr;}
+    
+    // Returns the frame to draw at the given time: a fresh capture if the
+    // view has changed and its refresh interval has passed, a one-line
+    // "unchanged" marker if it has not changed since it was last drawn,
+    // or nullptr if it is not due yet or has nothing to show.
+    std::shared_ptr<const View_frame> capture_if_due(int time);
+    
+    // Sets the fewest ticks between redraws; 0 redraws whenever drawn.
+    // Throws Error("Refresh interval must not be negative!") if negative.
+    void set_refresh_interval(int ticks);
 	
 	// Discard any saved information
     virtual void clear() {}
@@ -37,6 +106,17 @@ public:
     //Returns a string representation of the View.
     virtual std::string get_name() = 0;
 
+protected:
+    //A new view has not been drawn, so it starts out changed
+    View();
+    
+    //Records that what the view shows has changed since it was last drawn
+    void mark_dirty() {dirty = true;}
+
+private:
+    bool dirty;
+    int refresh_interval;
+    int last_drawn;//time of the last fresh capture, or -1 if none yet
 };
 
 #endif
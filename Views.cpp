@@ -1,12 +1,15 @@
 #include "Views.h"
 #include "Utility.h"
+#include "Model.h"
+#include "Location_store.h"
 #include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <iterator>
+#include <sstream>//ostringstream
+#include <algorithm>//min, max
 
 using std::string;
-using std::cout;
 using std::endl;
 using std::vector;
 using std::ios;
@@ -14,6 +17,12 @@ using std::setw;
 using std::list;
 using std::map;
 using std::ostream_iterator;
+using std::ostream;
+using std::shared_ptr;
+using std::make_shared;
+using std::pair;
+using std::make_pair;
+using std::to_string;
 
 const int min_map_size_c = 7;
 const int max_map_size_c = 30;
@@ -25,43 +34,126 @@ const int axis_print_frequency_c = 3;
 const int axis_precision_c = 0;
 const int local_map_size_c = 9;
 const double local_map_scale_c = 2.0;
+const int label_columns_c = 5;
+const double min_fixed_label_c = -999.5;
+const double max_fixed_label_c = 9999.5;
+const char* const ansi_escape_c = "\x1b[";
+const char* const ansi_save_cursor_c = "\x1b" "7";
+const char* const ansi_restore_cursor_c = "\x1b" "8";
 
-//constructs tile_view with given parameters
-Tile_view::Tile_view(int size_, double scale_,
-                     double origin_x, double origin_y):
-size(size_), scale(scale_), origin(origin_x, origin_y)
+//Map_frame adds the map parameters and the objects outside the map
+//to the grid of a Tile_frame
+class Map_frame : public Tile_frame {
+public:
+    Map_frame(int size_, double scale_, Point origin_,
+              vector<vector<string>> map_, list<string> outside_objs_) :
+    Tile_frame(size_, scale_, origin_, map_), outside_objs(outside_objs_)
+    {}
+    //Outputs current information about the map, any objects outside of
+    //it, and then the map.
+    void render(ostream& os) const override;
+private:
+    list<string> outside_objs;
+};
+
+//Ansi_map_frame draws a map for an ANSI terminal, at the top of the screen:
+//the parameters on the first line, then the grid and its axes. Everything
+//below the map is a scrolling region, so later output never moves it; the
+//objects outside the map are listed there. If the terminal already shows a
+//map with the same parameters, only the tiles that differ are rewritten.
+class Ansi_map_frame : public Tile_frame {
+public:
+    Ansi_map_frame(const Tile_screen& screen, const Tile_screen& previous_,
+                   list<string> outside_objs_) :
+    Tile_frame(screen), previous(previous_),
+    outside_objs(std::move(outside_objs_))
+    {}
+    //Formats the whole frame first, then writes it all at once
+    void render(ostream& os) const override;
+private:
+    Tile_screen previous;
+    list<string> outside_objs;
+    
+    //returns true if the terminal shows a map the tiles can be patched
+    //into: same parameters, and axis labels narrow enough that every
+    //tile is in its usual column
+    bool can_patch() const;
+    //writes cursor movements and the tiles that differ from previous
+    void render_changes(ostream& os) const;
+};
+
+//Local_frame announces whose local view it is before drawing the grid
+class Local_frame : public Tile_frame {
+public:
+    Local_frame(int size_, double scale_, Point origin_,
+                vector<vector<string>> map_, const string& followed_) :
+    Tile_frame(size_, scale_, origin_, map_), followed_object(followed_)
+    {}
+    void render(ostream& os) const override;
+private:
+    string followed_object;
+};
+
+//Info_frame is a copy of the data an Info_view showed when it was
+//captured, in the order it is to be output
+class Info_frame : public View_frame {
+public:
+    Info_frame(const string& title_, vector<pair<string, double>> data_) :
+    title(title_), object_data(std::move(data_))
+    {}
+    //Outputs information about the data given for each object
+    void render(ostream& os) const override;
+private:
+    string title;
+    vector<pair<string, double>> object_data;
+};
+
+//Takes ownership of the filled-in grid along with its parameters
+Tile_frame::Tile_frame(int size_, double scale_, Point origin_,
+                       Tile_grid map_) :
+size(size_), scale(scale_), origin(origin_),
+map(make_shared<const Tile_grid>(std::move(map_)))
 {
 }
-//empty dtor to enforce abstractedness
-Tile_view::~Tile_view()
+//Shares the screen's grid
+Tile_frame::Tile_frame(const Tile_screen& screen) :
+size(screen.size), scale(screen.scale), origin(screen.origin),
+map(screen.grid)
 {
-    
 }
 
-//Updates or creates the location of any object w/the given name
-void Tile_view::update_location(const string &name, Point location)
+//constructs tile_view with given parameters
+Tile_view::Tile_view(const Model& model_, int size_, double scale_,
+                     double origin_x, double origin_y):
+model(model_), size(size_), scale(scale_), origin(origin_x, origin_y)
 {
-    objects[name] = location;//just overwrite old one; otherwise
-    //ignore. easy-peasy!
 }
-//removes the given name from the map of objects
-//if no object matches, does nothing.
-void Tile_view::update_remove(const string &name)
+//empty dtor to enforce abstractedness
+Tile_view::~Tile_view()
 {
-    objects.erase(name);
+    
 }
 
-//draws the map as specified to stdout
-void Tile_view::draw()
+//captures the map as specified
+shared_ptr<const View_frame> Tile_view::capture()
 {
-    draw_map(gen_map());
+    return make_shared<Tile_frame>(size, scale, origin, gen_map());
 }
 
-vector<vector<string>> Tile_view::gen_map()
+Tile_grid Tile_view::gen_map()
 {
-    vector<vector<string>> map(size, vector<string>(size, empty_tile_c));
+    Tile_grid map(size, vector<string>(size, empty_tile_c));
     //create a 30x30 vector of strings initialized to the default empty tile
-    for(const auto &object_pair: objects) {
+    //pad the window by a tile so rounding never hides an object that
+    //get_subscripts would place on the edge
+    Region window = get_window();
+    window.lower_left = Point{window.lower_left.x - scale,
+                              window.lower_left.y - scale};
+    window.upper_right = Point{window.upper_right.x + scale,
+                               window.upper_right.y + scale};
+    auto visible_objects =
+        model.get_location_store().get_objects_in(window);
+    for(const auto &object_pair: visible_objects) {
         int x, y;//x and y location of object
         if(get_subscripts(x, y, object_pair.second)) {
             if(map[y][x] == empty_tile_c)
@@ -74,40 +166,41 @@ vector<vector<string>> Tile_view::gen_map()
     return map;//move semantics make this return not very
 }//costly at all!
 
-void Tile_view::draw_map(const vector<vector<string>>& map)
+//draws the map, labelling every few rows and columns
+void Tile_frame::render(ostream& os) const
 {
     for(int y = 0; y < size; y++) {
         int axis_val = size - y - 1;
         //since we're printing in opposite order, invert index(size - y)
         //and account for our y being off by one.
         if(axis_val % axis_print_frequency_c == 0) {
-            auto old_settings = cout.precision();//save old settings
-            cout << std::fixed<< std::setprecision(axis_precision_c);
-            cout << setw(4) << get_axis_label(axis_val, origin.y) << " ";
-            cout.precision(old_settings);//restore old settings
+            auto old_settings = os.precision();//save old settings
+            os << std::fixed<< std::setprecision(axis_precision_c);
+            os << setw(4) << get_axis_label(axis_val, origin.y) << " ";
+            os.precision(old_settings);//restore old settings
         }
         else {
-            cout << "     ";
+            os << "     ";
         }
-        const vector<string>& line = map[axis_val];
-        ostream_iterator<string> out_iter(cout);
+        const vector<string>& line = (*map)[axis_val];
+        ostream_iterator<string> out_iter(os);
         copy(line.begin(), line.end(), out_iter);
-        cout << endl;//new line after every individual line.
+        os << endl;//new line after every individual line.
     }//we have now printed each row, now to print the x axis
     for(int x = 0; x < size; x++) {
         if(x%axis_print_frequency_c == 0) {
-            auto old_settings = cout.precision();
-            cout << std::fixed <<std::setprecision(axis_precision_c);
-            cout << "  " << setw(4) << get_axis_label(x, origin.x);
-            cout.precision(old_settings);
+            auto old_settings = os.precision();
+            os << std::fixed <<std::setprecision(axis_precision_c);
+            os << "  " << setw(4) << get_axis_label(x, origin.x);
+            os.precision(old_settings);
         }
     }
-    cout << endl;//phew; done!
+    os << endl;//phew; done!
 }
 
 //Performs the equation which returns the expected value to be printed
 //as an axis label.
-double Tile_view::get_axis_label(int coord, double origin_mod)
+double Tile_frame::get_axis_label(int coord, double origin_mod) const
 {
     return coord * scale + origin_mod;
 }
@@ -135,12 +228,6 @@ bool Tile_view::get_subscripts(int &ix, int &iy, Point location)
         return true;
 }
 
-//clears the view of all currently saved objects
-void Tile_view::clear()
-{
-    objects.clear();
-}
-
 //sets the size of the view to the given size.
 //throws an error if out of bounds.
 void Tile_view::set_size(int size_)
@@ -152,6 +239,7 @@ void Tile_view::set_size(int size_)
         throw Error{"New map size is too small!"};
     }
     size = size_;
+    mark_dirty();
 }
 
 //sets the scale to the given scale number
@@ -162,24 +250,20 @@ void Tile_view::set_scale(double scale_)
         throw Error{"New map scale must be positive!"};
     }
     scale = scale_;
+    mark_dirty();
 }
 //sets the origin equal to the specified origin
 void Tile_view::set_origin(Point origin_) {
     origin = origin_;
-}
-//Outputs information about the current state of the map
-//to stdout. 
-void Tile_view::describe()
-{
-    cout << "Display size: " <<
-    size << ", scale: " << scale << ", origin: " <<
-    origin << endl;
+    mark_dirty();
 }
 
 //Returns a list of all objects currently outside of the grid
 list<string> Tile_view::get_outside_objects()
 {
     list<string> outside_objects;
+    const map<string, Point>& objects =
+        model.get_location_store().get_all();
     for(auto obj_pair_iter = objects.begin(); obj_pair_iter != objects.end();
         obj_pair_iter ++ ) {
         int garbagex, garbagey;//no need for the returned values here
@@ -190,16 +274,24 @@ list<string> Tile_view::get_outside_objects()
     return outside_objects;
 }
 
-//Returns an object of the given name. Assumes that one exists.
-Point Tile_view::get_object_location(const string& name)
+//The grid starts at the origin and is size tiles of scale units across
+Region Tile_view::get_window() const
+{
+    return Region{origin, Point{origin.x + size * scale,
+                                origin.y + size * scale}};
+}
+
+//Looks up the object's location in Model's store.
+//Returns false if there is no such object.
+bool Tile_view::get_object_location(const string& name, Point& location)
 {
-    return objects.find(name)->second;
+    return model.get_location_store().get_location(name, location);
 }
 
 
 //initializes map view and underlying tile_view with default settings
-Map_view::Map_view() :
-Tile_view()
+Map_view::Map_view(const Model& model_) :
+Tile_view(model_), ansi(false), last_screen{0, 0., Point(), nullptr}
 {
 }
 //restores parameters to the default values
@@ -209,22 +301,135 @@ void Map_view::set_defaults()
     set_scale(default_scale_c);
     set_origin(Point{default_origin_x_c, default_origin_y_c});
 }
+//The snapshot holds every object that is new or has moved
+void Map_view::sync(const View_snapshot& snapshot)
+{
+    if(!snapshot.locations.empty()) {
+        mark_dirty();
+    }
+}
+//Captures the map along with the objects outside of it. For a terminal,
+//the frame also remembers what the terminal showed before it.
+shared_ptr<const View_frame> Map_view::capture()
+{
+    if(!ansi) {
+        return make_shared<Map_frame>(get_size(), get_scale(), get_origin(),
+                                      gen_map(), get_outside_objects());
+    }
+    Tile_screen screen{get_size(), get_scale(), get_origin(),
+                       make_shared<const Tile_grid>(gen_map())};
+    shared_ptr<const View_frame> frame =
+        make_shared<Ansi_map_frame>(screen, last_screen,
+                                    get_outside_objects());
+    last_screen = screen;
+    return frame;
+}
+//Switching either way means the next drawing must start from scratch
+void Map_view::set_ansi(bool ansi_)
+{
+    ansi = ansi_;
+    last_screen.grid = nullptr;
+    mark_dirty();
+}
+//Resetting the scrolling region also homes the cursor, so it is saved
+//around the reset
+void Map_view::release_terminal(ostream& os)
+{
+    if(!ansi) {
+        return;
+    }
+    os << ansi_save_cursor_c << ansi_escape_c << "r" << ansi_restore_cursor_c;
+    os.flush();
+    last_screen.grid = nullptr;
+}
 //Outputs current information about the map, any users who are currently
 //outside the map, and then the map.
-void Map_view::draw()
+void Map_frame::render(ostream& os) const
 {
-    describe();
-    list<string> outside_objs = get_outside_objects();
+    os << "Display size: " <<
+    size << ", scale: " << scale << ", origin: " <<
+    origin << endl;
+    if(!outside_objs.empty()) {
+        for(const string& obj : outside_objs) {
+            os << obj;
+            if(obj != outside_objs.back()) {
+                os << ", ";
+            }
+        }
+        os << " outside the map" << endl;
+    }
+    Tile_frame::render(os);
+}
+//Clears the screen and draws everything if the tiles can't be patched,
+//then confines scrolling to the rows below the map. Patches are written
+//with the cursor saved, so output below the map carries on where it was.
+//Either way, the objects outside the map are listed with that output.
+void Ansi_map_frame::render(ostream& os) const
+{
+    std::ostringstream text;
+    text.copyfmt(os);
+    if(can_patch()) {
+        text << ansi_save_cursor_c;
+        render_changes(text);
+        text << ansi_restore_cursor_c;
+    } else {
+        text << ansi_escape_c << "r" << ansi_escape_c << "H"
+             << ansi_escape_c << "2J";
+        text << "Display size: " << size << ", scale: " << scale
+             << ", origin: " << origin << endl;
+        Tile_frame::render(text);
+        //setting the region homes the cursor, so move it back below the map
+        text << ansi_escape_c << (size + 3) << ";r"
+             << ansi_escape_c << (size + 3) << ";1H";
+    }
     if(!outside_objs.empty()) {
         for(const string& obj : outside_objs) {
-            cout << obj;
+            text << obj;
             if(obj != outside_objs.back()) {
-                cout << ", ";
+                text << ", ";
             }
         }
-        cout << " outside the map" << endl;
+        text << " outside the map" << endl;
+    }
+    const string& output = text.str();
+    os.write(output.data(), output.size());
+    os.flush();
+}
+//Labels are printed four wide, rounded to whole numbers; any wider and
+//the rows shift right
+bool Ansi_map_frame::can_patch() const
+{
+    if(!previous.grid || previous.size != size ||
+       previous.scale != scale || previous.origin != origin) {
+        return false;
+    }
+    double lowest = std::min(origin.x, origin.y);
+    double highest = std::max(origin.x, origin.y) + (size - 1) * scale;
+    return lowest > min_fixed_label_c && highest < max_fixed_label_c;
+}
+//The parameters line is row 1 and the top row of tiles is row 2; each row
+//starts with a label column. Runs of changed tiles need only one cursor
+//movement, since writing a tile leaves the cursor at the next one.
+void Ansi_map_frame::render_changes(ostream& os) const
+{
+    const Tile_grid& tiles = *map;
+    const Tile_grid& old_tiles = *previous.grid;
+    for(int y = 0; y < size; y++) {
+        bool cursor_here = false;
+        for(int x = 0; x < size; x++) {
+            if(tiles[y][x] == old_tiles[y][x]) {
+                cursor_here = false;
+                continue;
+            }
+            if(!cursor_here) {
+                os << ansi_escape_c << (size + 1 - y) << ";"
+                   << (label_columns_c + 1 + num_chars_per_tile_c * x)
+                   << "H";
+            }
+            os << tiles[y][x];
+            cursor_here = true;
+        }
     }
-    Tile_view::draw();
 }
 //Returns a string representation of this view
 string Map_view::get_name()
@@ -233,10 +438,12 @@ string Map_view::get_name()
 }
 //Constructs a tile view with the given "set" values of a local view's
 //parameters,
-Local_view::Local_view(const string& name) :
-Tile_view(local_map_size_c, local_map_scale_c), followed_object(name)
+Local_view::Local_view(const Model& model_, const string& name) :
+Tile_view(model_, local_map_size_c, local_map_scale_c), followed_object(name)
 {
-    Tile_view::set_origin(get_Origin_Value(get_object_location(name)));
+    Point location;
+    get_object_location(name, location);
+    Tile_view::set_origin(get_Origin_Value(location));
 }
 //returns the point from which the map's origin should be
 //if it is to be centered on the given location
@@ -248,77 +455,255 @@ Point Local_view::get_Origin_Value(const Point& location)
         location.y - (local_map_size_c / 2.) * local_map_scale_c;
     return Point{new_x_coord, new_y_coord};
 }
-//Updates the location of the given object. If the object is
-//the one we are currently following, update the origin as well.
+//Local_view's region of interest is just what it shows
+bool Local_view::get_region(Region& region) const
+{
+    region = get_window();
+    return true;
+}
+//Only objects inside the window change what is shown
+void Local_view::sync(const View_snapshot& snapshot)
+{
+    Region window = get_window();
+    for(const auto& loc_pair : snapshot.locations) {
+        if(window.contains(loc_pair.second)) {
+            mark_dirty();
+            return;
+        }
+    }
+}
+//Keeps the origin centered on the followed object as it moves;
+//anything else moving in or out of the window changes it too
 void Local_view::update_location(const string& name, Point location)
 {
-    Tile_view::update_location(name, location);
     if(name == followed_object) {
-        Tile_view::set_origin(get_Origin_Value(get_object_location(name)));
+        Tile_view::set_origin(get_Origin_Value(location));
     }
+    mark_dirty();
 }
-
-void Local_view::draw()
+//Moves the origin to keep the followed object centered; if it is gone,
+//the map stays where it last saw it.
+shared_ptr<const View_frame> Local_view::capture()
+{
+    Point location;
+    if(get_object_location(followed_object, location)) {
+        Tile_view::set_origin(get_Origin_Value(location));
+    }
+    return make_shared<Local_frame>(get_size(), get_scale(), get_origin(),
+                                    gen_map(), followed_object);
+}
+//Says whose view this is before drawing the grid
+void Local_frame::render(ostream& os) const
 {
-    cout << "Local view for: " << followed_object << endl;
-    Tile_view::draw();
+    os << "Local view for: " << followed_object << endl;
+    Tile_frame::render(os);
 }
 //Constructs an instance of this with the given label of output
-Info_view::Info_view(const std::string& name_of_data)  :
-data_name(name_of_data)
+Info_view::Info_view(const Model& model_, const std::string& name_of_data)  :
+model(model_), data_name(name_of_data), ranking(UNRANKED), rank_count(0)
 {
 }
 //empty destructor to enforce abstractedness
 Info_view::~Info_view()
 {
 }
+//Copies the data for each object shown into a frame. Unranked, the
+//objects are visited in name order, starting at the prefix if there is
+//one; ranked, in value order until enough are found.
+shared_ptr<const View_frame> Info_view::capture()
+{
+    vector<pair<string, double>> shown;
+    if(ranking == UNRANKED) {
+        auto data_iter = name_prefix.empty() ? object_data.begin() :
+            object_data.lower_bound(name_prefix);
+        for(; data_iter != object_data.end(); ++data_iter) {
+            if(data_iter->first.compare(0, name_prefix.length(),
+                                        name_prefix) != 0) {
+                break;//past the last name with the prefix
+            }
+            if(is_shown(data_iter->first)) {
+                shown.push_back(*data_iter);
+            }
+        }
+    } else {
+        for(const auto& entry : ranked_data) {
+            if(static_cast<int>(shown.size()) == rank_count) break;
+            if(is_shown(entry.second)) {//negating twice gives the value back
+                shown.push_back(make_pair(entry.second,
+                                          rank_key(entry.first)));
+            }
+        }
+    }
+    return make_shared<Info_frame>(data_name + describe_selection(),
+                                   std::move(shown));
+}
 //Outputs information about the data given for each object
-void Info_view::draw()
+void Info_frame::render(ostream& os) const
+{
+    os << "Current " << title << ":" << endl;
+    os << "--------------" << endl;
+    for(const auto& data_pair : object_data) {
+        os << data_pair.first << ": " << data_pair.second << endl;
+    }
+    os << "--------------" << endl;
+}
+//Rebuilds the ranked set from scratch whenever the order changes, and
+//drops it when ranking is turned off
+void Info_view::set_ranking(Ranking_e ranking_, int count)
+{
+    if(ranking_ != UNRANKED && count <= 0) {
+        throw Error{"Count must be positive!"};
+    }
+    if(ranking_ != ranking) {
+        ranked_data.clear();
+        ranking = ranking_;
+        if(ranking != UNRANKED) {
+            for(const auto& data_pair : object_data) {
+                ranked_data.insert(make_pair(rank_key(data_pair.second),
+                                             data_pair.first));
+            }
+        }
+    }
+    rank_count = ranking == UNRANKED ? 0 : count;
+    mark_dirty();
+}
+//Takes effect the next time the view is drawn
+void Info_view::set_name_filter(const string& prefix)
+{
+    name_prefix = prefix;
+    mark_dirty();
+}
+//Takes effect the next time the view is drawn
+void Info_view::set_type_filter(const string& type)
 {
-    cout << "Current " << data_name << ":" << endl;
-    cout << "--------------" << endl;
-    for(auto map_iter = object_data.begin(); map_iter != object_data.end();
-        map_iter++) {
-        cout << map_iter->first << ": " << map_iter->second << endl;
+    type_name = type;
+    mark_dirty();
+}
+//The prefix is checked first, since it doesn't need to ask the Model
+bool Info_view::is_shown(const string& name) const
+{
+    if(name.compare(0, name_prefix.length(), name_prefix) != 0) {
+        return false;
+    }
+    if(type_name.empty()) {
+        return true;
+    }
+    const char* type = model.get_type_name(name);
+    return type && type_name == type;
+}
+//Returns "" if everything is shown, or something like
+//" (lowest 5, names starting with Ar, type Archer)"
+string Info_view::describe_selection() const
+{
+    vector<string> parts;
+    if(ranking != UNRANKED) {
+        parts.push_back(string(ranking == LOWEST_FIRST ? "lowest " :
+                               "highest ") + to_string(rank_count));
+    }
+    if(!name_prefix.empty()) {
+        parts.push_back("names starting with " + name_prefix);
+    }
+    if(!type_name.empty()) {
+        parts.push_back("type " + type_name);
+    }
+    if(parts.empty()) {
+        return "";
     }
-    cout << "--------------" << endl;
+    string selection = " (" + parts.front();
+    for(auto part_iter = parts.begin() + 1; part_iter != parts.end();
+        ++part_iter) {
+        selection += ", " + *part_iter;
+    }
+    return selection + ")";
 }
-//Updates the information for the given object
+//Updates the information for the given object; objects often report
+//the same value again, which changes nothing
 void Info_view::insert(const std::string &name, double data)
 {
-    object_data[name] = data;
+    auto data_iter = object_data.find(name);
+    if(data_iter == object_data.end()) {
+        object_data.insert(make_pair(name, data));
+    } else if(data_iter->second != data) {
+        if(ranking != UNRANKED) {
+            ranked_data.erase(make_pair(rank_key(data_iter->second), name));
+        }
+        data_iter->second = data;
+    } else {
+        return;
+    }
+    if(ranking != UNRANKED) {
+        ranked_data.insert(make_pair(rank_key(data), name));
+    }
+    mark_dirty();
+}
+//Copies the whole map if we have nothing yet, which is the usual case
+//when a view is attached; otherwise merges it entry by entry
+void Info_view::insert_all(const map<string, double>& data)
+{
+    if(object_data.empty() && ranking == UNRANKED) {
+        if(!data.empty()) {
+            object_data = data;
+            mark_dirty();
+        }
+        return;
+    }
+    for(const auto& data_pair : data) {
+        insert(data_pair.first, data_pair.second);
+    }
 }
 //Clears the map of all objects
 void Info_view::clear()
 {
-    object_data.clear();
+    if(!object_data.empty()) {
+        object_data.clear();
+        ranked_data.clear();
+        mark_dirty();
+    }
 }
 //Removes the given object from the map
 void Info_view::update_remove(const string &name)
 {
-    object_data.erase(name);
+    auto data_iter = object_data.find(name);
+    if(data_iter == object_data.end()) {
+        return;
+    }
+    if(ranking != UNRANKED) {
+        ranked_data.erase(make_pair(rank_key(data_iter->second), name));
+    }
+    object_data.erase(data_iter);
+    mark_dirty();
 }
 //Constructs Health_view by notifying base class of what info it contains
-Health_view::Health_view() : Info_view("Health")
+Health_view::Health_view(const Model& model_) : Info_view(model_, "Health")
 {}
 //Updates the health of the given object
 void Health_view::update_health(const string &name, double health)
 {
     insert(name, health);
 }
+//Takes all of the healths from the snapshot at once
+void Health_view::sync(const View_snapshot& snapshot)
+{
+    insert_all(snapshot.healths);
+}
 //Returns a string representation of this view
 string Health_view::get_name()
 {
     return health_view_name_c;
 }
 //Constructs Info_view by notifying base class it contains info on amounts
-Amount_view::Amount_view() : Info_view("Amounts")
+Amount_view::Amount_view(const Model& model_) : Info_view(model_, "Amounts")
 {}
 //Calls insert to update the amount given
 void Amount_view::update_amount(const std::string &name, double amount)
 {
     insert(name, amount);
 }
+//Takes all of the amounts from the snapshot at once
+void Amount_view::sync(const View_snapshot& snapshot)
+{
+    insert_all(snapshot.amounts);
+}
 //Returns a string representation of this view
 string Amount_view::get_name()
 {
@@ -5,32 +5,61 @@
 #include <map>//map
 #include <vector>//generated map
 #include <list>//list of objects outside the map return
+#include <set>//ranked data
+#include <utility>//pair
+#include <memory>//captured frames
+
+class Model;
 
 static const int default_size_c = 25;
 static const double default_scale_c = 2.0;
 static const double default_origin_x_c = -10.0;
 static const double default_origin_y_c = -10.0;
 
+//The tiles of a map, indexed [y][x] with y = 0 at the bottom
+typedef std::vector<std::vector<std::string>> Tile_grid;
+
+//What a map looked like when it was drawn: its parameters and its tiles.
+//The grid is shared, so frames can refer to it without copying it.
+struct Tile_screen {
+    int size;
+    double scale;
+    Point origin;
+    std::shared_ptr<const Tile_grid> grid;
+};
+
+//A Tile_frame is the grid a Tile_view shows, already filled in, along with
+//the size, scale and origin needed to label its axes.
+class Tile_frame : public View_frame {
+public:
+    Tile_frame(int size_, double scale_, Point origin_, Tile_grid map_);
+    //Shares an already filled-in screen
+    Tile_frame(const Tile_screen& screen);
+    //draws out the 2-dimensional map with its axis labels
+    void render(std::ostream& os) const override;
+protected:
+    int size;
+    double scale;
+    Point origin;
+    std::shared_ptr<const Tile_grid> map;
+    
+    //Performs the equation which returns the expected value to
+    //be printed as an axis label.
+    double get_axis_label(int coord, double origin_mod) const;
+};
+
 //This class provides a basic interface for drawing tiles to the
 //stdout in the form of a map. Note that it does not have any details
-//on the objects it prints, just the location and name
+//on the objects it prints, just the location and name.
+//It keeps no copy of the objects; it is a window onto its Model's location
+//store, and pulls the objects it needs from there when it draws.
 class Tile_view : public View {
 public:
     //make pure virtual:
     virtual ~Tile_view() = 0;
     
-    // Save the supplied name and location for future use in a draw() call
-    // If the name is already present,the new location replaces the previous one.
-    virtual void update_location(const std::string& name,
-                                 Point location) override;
-    
-    // Remove the name and its location; no error if the name is not present.
-    virtual void update_remove(const std::string& name) override;
-    
-    // prints out the current map
-    virtual void draw();
-    // Discard the saved information - drawing will show only a empty pattern
-    void clear() override;
+    // captures the current map
+    std::shared_ptr<const View_frame> capture() override;
     
     // modify the display parameters
     // if the size is out of bounds will throw Error("New map size is too big!")
@@ -44,37 +73,36 @@ public:
     virtual void set_origin(Point origin_);
     
 protected:
-    //Default constructor takes in the size, scale, and origin coords
-    //And initializes them to the given values
-    Tile_view(int size_ = default_size_c,
+    //Constructor takes in the world to show, and the size, scale, and
+    //origin coords, and initializes them to the given values
+    Tile_view(const Model& model_, int size_ = default_size_c,
               double scale_ = default_scale_c,
               double origin_x = default_origin_x_c,
               double origin_y = default_origin_y_c);
     
-    //draws out a given 2-dimensional map to stdout.
-    void draw_map(const std::vector<std::vector<std::string>>& map);
-    
     //generates a 2-dimensional map from the current map of objects
-    std::vector<std::vector<std::string>> gen_map();
+    Tile_grid gen_map();
     
-    //outputs information about the current state of the map to cout
-    void describe();
+    //readers for the current display parameters
+    int get_size() const {return size;}
+    double get_scale() const {return scale;}
+    Point get_origin() const {return origin;}
     
     //returns a list of objects which are outside of the current grid
     std::list<std::string> get_outside_objects();
     
-    //returns the current location of a given object
-    Point get_object_location(const std::string& name);
+    //returns the part of the world covered by the grid
+    Region get_window() const;
+    
+    //If the given object exists, sets location to where it is and
+    //returns true; returns false otherwise.
+    bool get_object_location(const std::string& name, Point& location);
     
 private:
+    const Model& model;
     int size;
     double scale;
     Point origin;
-    std::map<std::string, Point> objects;
-    
-    //Performs the equation which returns the expected value to
-    //be printed as an axis label.
-    double get_axis_label(int coord, double origin_mod);
     
     //returns true if point is within the grid, false otherwise
     bool get_subscripts(int &ix, int &iy, Point location);
@@ -84,31 +112,63 @@ private:
 class Map_view: public Tile_view
 {
     public:
-    //constructs a map view with the specified default vals
-    Map_view();
+    //constructs a map view of the world with the specified default vals
+    Map_view(const Model& model_);
+    
+    //Map_view pulls everything it draws from Model's location store,
+    //so it only listens for moves and removals to know it has changed
+    int get_interests() const override
+        {return LOCATION_INTEREST | GONE_INTEREST;}
+    //Any new or moved object changes the map or its list of outsiders
+    void sync(const View_snapshot& snapshot) override;
+    void update_location(const std::string& name,
+                         Point location) override {mark_dirty();}
+    void update_remove(const std::string& name) override {mark_dirty();}
     
-    //overrides draw to also give information on anyone outside
+    //overrides capture to also give information on anyone outside
     //the map, and give current map parameters
-    void draw() override;
+    std::shared_ptr<const View_frame> capture() override;
     
+    //Turns drawing for an ANSI terminal on or off. When on, the map stays
+    //at the top of the screen, above a scrolling region for everything
+    //else, and each drawing after the first only rewrites the tiles that
+    //changed, using cursor movement sequences.
+    void set_ansi(bool ansi_);
+    //If drawing for an ANSI terminal, writes what gives the whole screen
+    //back to scrolling output; the next drawing starts from scratch.
+    //Nothing else may be drawing the map when this is called.
+    void release_terminal(std::ostream& os);
     
     // set the parameters to the default values
     void set_defaults();
     //returns the internal str representation of this view
     std::string get_name() override;
     
+private:
+    bool ansi;
+    //what the terminal was last sent; its grid is nullptr if nothing
+    //has been sent since ANSI drawing was turned on
+    Tile_screen last_screen;
 };
 
 class Local_view: public Tile_view
 {
     public:
-    //Constructs a view of a map centered on a single object.
-    Local_view(const std::string &name);
-    //Updates the location of the given object,
-    //and if it is our followed object,
-    //updates our origin as well. 
+    //Constructs a view of a map centered on a single object of the world.
+    Local_view(const Model& model_, const std::string &name);
+    //Only wants to hear about objects moving around its own window
+    int get_interests() const override
+        {return LOCATION_INTEREST | GONE_INTEREST;}
+    //Sets region to the part of the world currently in view
+    bool get_region(Region& region) const override;
+    //Nothing to catch up on, since the location store already has it
+    //all, but new objects in view change what is shown
+    void sync(const View_snapshot& snapshot) override;
+    //If the given object is the one we follow, recenters on it
     void update_location(const std::string& name,
                          Point location) override;
+    //Anything leaving the window changes what is shown
+    void update_remove(const std::string& name) override {mark_dirty();}
     //Overrides virtual function to do nothing
     void set_size(int size_) override {}
     
@@ -120,9 +180,9 @@ class Local_view: public Tile_view
     std::string get_name() override {
         return followed_object;
     }
-    //Outputs information about what is being drawn
-    //before drawing
-    void draw() override;
+    //Centers on the followed object's current location, then
+    //captures the map along with what is being drawn
+    std::shared_ptr<const View_frame> capture() override;
 private:
     //returns the point which should be an origin to center
     //at a given location.
@@ -132,33 +192,74 @@ private:
 };
 
 //Info_view holds a single datum about the given
+//object. It can be told to show only the few objects with the lowest or
+//highest values, kept in order as the values change, and only the objects
+//whose names start with a prefix or that are of a given type.
 class Info_view: public View
 {
 public:
+    enum Ranking_e {UNRANKED, LOWEST_FIRST, HIGHEST_FIRST};
+    
     virtual ~Info_view() = 0;//force abstractedness
-    //Outputs information about the data given for each object. 
-    void draw() override;
+    //Captures the data given for each object that is shown; only as many
+    //objects are looked at as there are to show, unless a filter leaves
+    //out many of the ones ranked first.
+    std::shared_ptr<const View_frame> capture() override;
+    //Shows only the count objects with the lowest or highest values,
+    //in that order, or every object in name order if UNRANKED.
+    //Throws Error("Count must be positive!") if ranked and count isn't.
+    void set_ranking(Ranking_e ranking_, int count);
+    //Shows only objects whose names start with the prefix; an empty
+    //prefix shows every name
+    void set_name_filter(const std::string& prefix);
+    //Shows only objects of the named type; an empty name shows every type
+    void set_type_filter(const std::string& type);
     //Clears the object of any given objects
     void clear() override;
     //Removes the given object from the map of objects.
     void update_remove(const std::string& name) override;
 protected:
-    //Builds an info_view with an internal name for the data
-    Info_view(const std::string& name_of_data);
-    //Inserts the given pair into the object_data map.
+    //Builds an info_view of the world with an internal name for the data
+    Info_view(const Model& model_, const std::string& name_of_data);
+    //Inserts the given pair into the object_data map, noting a change
+    //only if the value is new or different.
     void insert(const std::string& name, double data);
+    //Inserts every pair of the given map, replacing any existing values
+    void insert_all(const std::map<std::string, double>& data);
 private:
+    const Model& model;
     std::map<std::string, double> object_data;
     std::string data_name;
+    Ranking_e ranking;
+    int rank_count;
+    //a (rank key, name) pair for every object, kept only while ranked;
+    //the objects to show first come first, ties in name order
+    std::set<std::pair<double, std::string>> ranked_data;
+    std::string name_prefix;
+    std::string type_name;
+    
+    //returns the value itself if lowest first, or its negation if
+    //highest first, so ranked_data can always be read front to back
+    double rank_key(double value) const
+        {return ranking == HIGHEST_FIRST ? -value : value;}
+    //returns true if the object passes the name and type filters
+    bool is_shown(const std::string& name) const;
+    //returns what is being shown, for the frame's title
+    std::string describe_selection() const;
 };
 
 class Health_view: public Info_view
 {
 public:
     //constructs Info_view with the given type of data
-    Health_view();
+    Health_view(const Model& model_);
+    //Only wants health and removals
+    int get_interests() const override
+        {return HEALTH_INTEREST | GONE_INTEREST;}
     //Updates the health for the given object via. calling insert
     void update_health(const std::string& name, double health) override;
+    //Takes every health in the snapshot in one go
+    void sync(const View_snapshot& snapshot) override;
     //Returns the internal representation of the view
     std::string get_name() override;
 };
@@ -168,8 +269,13 @@ class Amount_view: public Info_view
 public:
     //Updates the amount given in object_data with new amount
     void update_amount(const std::string& name, double amount) override;
+    //Takes every amount in the snapshot in one go
+    void sync(const View_snapshot& snapshot) override;
     //Constructs Info_view with the given type of data
-    Amount_view();
+    Amount_view(const Model& model_);
+    //Only wants amounts and removals
+    int get_interests() const override
+        {return AMOUNT_INTEREST | GONE_INTEREST;}
     //Returns the internal representation of the view's name
     std::string get_name() override;
 };
@@ -2,8 +2,12 @@
 #include "Utility.h"
 #include "Geometry.h"
 #include "Model.h"
+#include "State_hash.h"
+#include "Binary_writer.h"
+#include "Binary_reader.h"
 #include "Structure.h"
-#include <iostream>//cout, endl
+#include "Spatial_grid.h"//Region
+#include <ostream>//endl
 #include <cassert>
 
 const int default_soldier_strength_c = 2;
@@ -12,9 +16,12 @@ const char* const default_soldier_msg_c = "Clang!";
 const int default_archer_strength_c = 1;
 const double default_archer_range_c = 6.0;
 const char* const default_archer_msg_c = "Twang!";
+//widens the range square so that agents right at the edge of the range,
+//where the square's upper bounds are open, are still noticed
+const double range_square_margin_c = 0.01;
+const char* const retarget_task_c = "retarget";
 
 using std::string;
-using std::cout;
 using std::endl;
 using std::shared_ptr;
 using std::weak_ptr;
@@ -53,7 +60,8 @@ void Warrior::start_attacking(weak_ptr<Agent> target_ptr)
 //assumes the target is valid and sets it to be attacked
 void Warrior::attack_target(weak_ptr<Agent> target_ptr)
 {
-    cout << get_name() << ": I'm attacking!" << endl;
+    get_output() << get_name() << ": I'm attacking!" << endl;
+    will_change();
     attacking = true;
     target = target_ptr;
 }
@@ -65,9 +73,18 @@ bool Warrior::in_range(shared_ptr<Agent> target_ptr) const
                     target_ptr->get_location()) <= range;
 }
 
+//Only the circle of range matters, but a square is what can be watched
+Region Warrior::get_range_square() const
+{
+    Point center = get_location();
+    double half_width = range + range_square_margin_c;
+    return Region{Point{center.x - half_width, center.y - half_width},
+                  Point{center.x + half_width, center.y + half_width}};
+}
+
 //Updates the soldier by analyzing current target; if no target,
-//does nothing. If target, moves to strike if valid target.
-//Discards target if invalid.
+//does nothing. If target, strikes it if valid target, leaving Model to
+//deliver the hit. Discards target if invalid.
 void Warrior::update()
 {
     Agent::update();
@@ -77,45 +94,98 @@ void Warrior::update()
     //if this far, means alive & attacking
     shared_ptr<Agent> cur_target = target.lock();
     if(!cur_target || !cur_target->is_alive()) {
-        cout << get_name() << ": Target is dead" << endl;
+        get_output() << get_name() << ": Target is dead" << endl;
+        will_change();
         attacking = false;
         return;
     }
     if(!in_range(cur_target)) {
-        cout << get_name() << ": Target is now out of range" << endl;
+        get_output() << get_name() << ": Target is now out of range" << endl;
+        will_change();
         attacking = false;
         return;
     }//else we can strike:
-    cout << get_name() << ": " << attack_msg << endl;
-    cur_target->take_hit(strength, shared_from_this());
-    if(!cur_target->is_alive()) {
-        //if we killed the target, celebrate!
-        cout << get_name() << ": I triumph!" << endl;
+    get_output() << get_name() << ": " << attack_msg << endl;
+    get_model().queue_hit(cur_target, shared_from_this(), strength);
+    //the target takes the hit once everyone has struck
+}
+
+//If we killed our target, celebrate!
+void Warrior::target_killed(shared_ptr<Agent> killed)
+{
+    if(attacking && target.lock() == killed) {
+        get_output() << get_name() << ": I triumph!" << endl;
+        will_change();
         attacking = false;
     }
 }
 
+//A target that has left this world is gone from the new one too
+void Warrior::relink()
+{
+    Agent::relink();
+    shared_ptr<Agent> old_target = target.lock();
+    if(old_target && get_model().is_agent_present(old_target->get_name())) {
+        target = get_model().get_agent_ptr(old_target->get_name());
+    }
+    else {
+        target.reset();
+    }
+}
+
 //Outputs the Warrior and Agent information, mainly to include
 //type of agent and whether or not they're attacking
 void Warrior::describe() const
 {
     Agent::describe();
     if(!is_alive()) {
-        cout << "   Is dead" << endl;//shouldn't appear in this proj
+        get_output() << "   Is dead" << endl;//shouldn't appear in this proj
     }
     if(is_attacking()){
         if(target.expired() || !target.lock()->is_alive())
-            cout << "   Attacking dead target" << endl;
+            get_output() << "   Attacking dead target" << endl;
         else
-            cout << "   Attacking " << target.lock()->get_name() << endl;
+            get_output() << "   Attacking " << target.lock()->get_name() << endl;
     }
     else
-        cout << "   Not attacking" << endl;
+        get_output() << "   Not attacking" << endl;
+}
+//The target is mixed in by name, and only while attacking
+void Warrior::hash_state(State_hash& hash) const
+{
+    Agent::hash_state(hash);
+    hash.add(attacking);
+    shared_ptr<Agent> target_ptr = target.lock();
+    if(attacking && target_ptr) {
+        hash.add(target_ptr->get_name());
+    }
+}
+//A target that has already died is written as no target
+void Warrior::write_state(Binary_writer& writer) const
+{
+    Agent::write_state(writer);
+    writer.put(static_cast<uint8_t>(attacking));
+    shared_ptr<Agent> target_ptr = target.lock();
+    writer.put_string(target_ptr && get_model().is_agent_present(
+        target_ptr->get_name()) ? target_ptr->get_name() : string());
+}
+//Every living agent has already been added to the world
+void Warrior::read_state(Binary_reader& reader)
+{
+    Agent::read_state(reader);
+    attacking = reader.get<uint8_t>() != 0;
+    string target_name = reader.get_string();
+    if(target_name.empty()) {
+        target.reset();
+    }
+    else {
+        target = get_model().get_agent_ptr(target_name);
+    }
 }
 //Outputs a message that a True Warrior doesn't stop.
 void Warrior::stop()
 {
-    cout << get_name() << ": Don't bother me" << endl;
+    get_output() << get_name() << ": Don't bother me" << endl;
 }
 
 //Constructs a soldier by calling the Warrior base ctor,
@@ -145,28 +215,80 @@ void Soldier::take_hit(int attack_strength,
 //Outputs that the Agent is a soldier before proceeding with Warrior describe
 void Soldier::describe() const
 {
-    cout << "Soldier ";
+    get_output() << "Soldier ";
     Warrior::describe();
 }
 //Constructs an Archer by providing Warrior with the given defaults
 //as well as the given name and location
 Archer::Archer(const string& name_, Point location_) :
 Warrior(name_, location_, default_archer_strength_c, default_archer_range_c,
-        default_archer_msg_c)
-{//no extra work required
+        default_archer_msg_c), retarget_pending(false)
+{
 }
-//calls Warrior::update; if it is not in an attack state, find a new target
+//calls Warrior::update; if it is not in an attack state, find a new target.
+//If nobody was in range last time, nobody can be now unless the Archer has
+//moved or its watch on its range has ended, so it doesn't look again.
+//The search is posted to Model, which may put it off to a later tick.
 void Archer::update()
 {
     Warrior::update();
-    if(!is_attacking()) {
-        shared_ptr<Agent> closest =
-            Model::get_instance().get_closest_agent(shared_from_this());
-        if(!in_range(closest)) {
-            return;//if closest not in range, do nothing
+    if(is_attacking() || retarget_pending) {
+        return;
+    }
+    if(get_location() == watch_location &&
+       get_model().is_watched(get_name())) {
+        return;
+    }
+    will_change();
+    retarget_pending = true;
+    weak_ptr<Agent> self = shared_from_this();
+    get_model().post_task(retarget_task_c, [self]() {
+        shared_ptr<Archer> archer =
+            std::static_pointer_cast<Archer>(self.lock());
+        if(archer) {
+            archer->retarget();
         }
-        attack_target(closest);
+    });
+}
+//By the time this runs the Archer may have died or found a target
+void Archer::retarget()
+{
+    will_change();
+    retarget_pending = false;
+    if(!is_alive() || is_attacking()) {
+        return;
     }
+    shared_ptr<Agent> closest =
+        get_model().get_closest_agent(shared_from_this());
+    if(!closest || !in_range(closest)) {
+        //if closest not in range, wait for someone to come near
+        watch_location = get_location();
+        get_model().watch_region(get_name(), get_range_square());
+        return;
+    }
+    attack_target(closest);
+}
+
+//The posted search stays behind in the old world's queue
+void Archer::relink()
+{
+    Warrior::relink();
+    retarget_pending = false;
+}
+//A search waiting in the task queue is not written, so it looks again
+void Archer::write_state(Binary_writer& writer) const
+{
+    Warrior::write_state(writer);
+    writer.put(watch_location.x);
+    writer.put(watch_location.y);
+}
+//Model puts the watch on the range back itself
+void Archer::read_state(Binary_reader& reader)
+{
+    Warrior::read_state(reader);
+    watch_location.x = reader.get<double>();
+    watch_location.y = reader.get<double>();
+    retarget_pending = false;
 }
 
 //Overrides Agent's take_hit to run away when attacked
@@ -177,14 +299,14 @@ void Archer::take_hit(int attack_strength, std::weak_ptr<Agent> attacker_ptr)
         return;//welp. nothing else we can do
     }
     shared_ptr<Structure> closest =
-        Model::get_instance().get_closest_structure(shared_from_this());
-    cout << get_name() << ": I'm going to run away to " <<
+        get_model().get_closest_structure(shared_from_this());
+    get_output() << get_name() << ": I'm going to run away to " <<
         closest->get_name() << endl;
     move_to(closest->get_location());
 }
 //Outputs that the Agent is an Archer before proceeding with Warrior describe
 void Archer::describe() const
 {
-    cout << "Archer ";
+    get_output() << "Archer ";
     Warrior::describe();
 }
@@ -2,6 +2,9 @@
 #define WARRIORS_H
 
 #include "Agent.h"
+#include "Geometry.h"//Point
+
+struct Region;
 
 class Warrior: public Agent {
 public:
@@ -20,10 +23,21 @@ public:
     virtual void update();
     //Outputs information about the current state of the Warrior to stdout
     virtual void describe() const;
+    //mixes in whether it is attacking, and whom
+    void hash_state(State_hash& hash) const override;
+    //also writes or reads back whether it is attacking, and whom by name
+    void write_state(Binary_writer& writer) const override;
+    void read_state(Binary_reader& reader) override;
     
     // Overrides Agent's stop to print a message
     void stop() override;
     
+    // Celebrates and stops attacking if it was the current target
+    void target_killed(std::shared_ptr<Agent> killed) override;
+    
+    // attacks the agent of the same name in the new world
+    void relink() override;
+    
 protected:
     //Sets the target to be the target, moves to state is_attacking
     //and announces the attack
@@ -31,6 +45,8 @@ protected:
     //returns true if the target_ptr is in range
     //false otherwise
     bool in_range(std::shared_ptr<Agent> target_ptr) const;
+    //returns the square just enclosing the Warrior's range
+    Region get_range_square() const;
     //Returns true if the warrior is currently attacking
     //False otherwise
     bool is_attacking() const { return attacking; }
@@ -48,9 +64,17 @@ private:
 class Soldier : public Warrior{
 
 public:
+    //the name this type is created by
+    static constexpr const char* type_name() {return "Soldier";}
+    const char* get_type_name() const override {return type_name();}
+
 	//Constructs a Soldier using the given Soldier defaults and the
     //name and location passed.
 	Soldier(const std::string& name_, Point location_);
+    std::shared_ptr<Agent> clone() const override
+        {return std::make_shared<Soldier>(*this);}
+    void restore(const Sim_object& saved) override
+        {*this = static_cast<const Soldier&>(saved);}
 	
 	// Overrides Agent's take_hit to counterattack when attacked.
 	void take_hit(int attack_strength,
@@ -63,18 +87,44 @@ public:
 
 class Archer: public Warrior {
 public:
+    //the name this type is created by
+    static constexpr const char* type_name() {return "Archer";}
+    const char* get_type_name() const override {return type_name();}
+
     //Constructs an Archer using the given Archer defaults
     //and the name and location passed
     Archer(const std::string& name_, Point location_);
+    std::shared_ptr<Agent> clone() const override
+        {return std::make_shared<Archer>(*this);}
+    void restore(const Sim_object& saved) override
+        {*this = static_cast<const Archer&>(saved);}
+    
+    // the new world has no search waiting for it, so it looks again
+    void relink() override;
+    //also writes or reads back where it last found nobody in range
+    void write_state(Binary_writer& writer) const override;
+    void read_state(Binary_reader& reader) override;
     
     //Updates by calling the typical Warrior behavior,
-    //but proceeds to pick a new target if the current is killed. 
+    //but proceeds to pick a new target if the current is killed.
+    //Having found nobody in range, it doesn't look again until it has
+    //moved or something has come near.
     void update() override;
     //Overrides Agent's take_hit to run away when attacked
     void take_hit(int attack_strength,
                   std::weak_ptr<Agent> attacker_ptr) override;
     //Overrides describe to also output that the Agent is an archer
     void describe() const override;
+    
+private:
+    //where the Archer was when it last found nobody in range
+    Point watch_location;
+    //true while a search for a target is waiting to be done
+    bool retarget_pending;
+    
+    //attacks the closest agent if it is in range; otherwise has Model
+    //watch the range for newcomers
+    void retarget();
 };
 
 #endif